@@ -36,7 +36,7 @@ template<typename _Tp, typename _Compare = std::less<_Tp>,
 std::ostream& operator<<(std::ostream &stream, const int_map<_Tp, _Alloc, _Compare> & cntr)
 {
     for (const auto& p: cntr)
-        stream << p.first << " " << p.second << std::endl;
+        stream << p.first << ' ' << p.second << '\n';
     return stream;
 }
 
@@ -46,39 +46,66 @@ template<typename _Tp, typename _Alloc = std::allocator<_Tp>>
 std::ostream& operator<<(std::ostream &stream, int_list<_Tp, _Alloc>& cntr)
 {
     for (const auto& p: cntr)
-         stream << p << std::endl;
+         stream << p << '\n';
     return stream;
 }
 
+//Bulk load of a range sorted by key. Keys have to be greater than the ones
+//already stored, then every element is linked at the end of the tree in
+//amortized constant time
+template<typename _Tp, typename _Compare = std::less<_Tp>,
+         typename _Alloc = std::allocator<std::pair<const _Tp, _Tp> >, typename InputIt>
+void load_sorted(int_map<_Tp, _Alloc, _Compare> & cntr, InputIt first, InputIt last)
+{
+    for( ; first != last; ++first)
+        cntr.emplace_hint(std::end(cntr), *first);
+}
+
+template<typename _Tp, typename _Alloc = std::allocator<_Tp>, typename InputIt>
+void load_sorted(int_list<_Tp, _Alloc>& cntr, InputIt first, InputIt last)
+{
+    cntr.push_front(first, last);
+}
+
+//Same as load_sorted for values produced by the generator in ascending order
+template<typename _Tp, typename _Compare = std::less<_Tp>,
+         typename _Alloc = std::allocator<std::pair<const _Tp, _Tp> >, typename Generator>
+void generate_sorted(int_map<_Tp, _Alloc, _Compare> & cntr, int times, Generator gen)
+{
+    for(auto i = 0; i < times; i++)
+        cntr.emplace_hint(std::end(cntr), gen());
+}
+
+template<typename _Tp, typename _Alloc = std::allocator<_Tp>, typename Generator>
+void generate_sorted(int_list<_Tp, _Alloc>& cntr, int times, Generator gen)
+{
+    if(times > 0)
+        cntr.generate_front(times, gen);
+}
+
 template<typename _Tp, typename _Compare = std::less<_Tp>,
          typename _Alloc = std::allocator<std::pair<const _Tp, _Tp> > >
 void fill_cntr(int_map<_Tp, _Alloc, _Compare> & cntr, int times = 10)
 {
-    auto inserter = [](auto & container) { return std::inserter(container, std::begin(container));};
-
-    auto make_factorial = [i = 0]() mutable
+    //The factorial is carried from the previous key, so the fill is linear.
+    //The product wraps in unsigned arithmetic instead of overflowing _Tp
+    auto make_factorial = [i = _Tp{}, f = 1ull]() mutable
     {
-        auto f = factorial(i);
-        auto value = std::make_pair(i,f);
+        if(i)
+            f *= static_cast<unsigned long long>(i);
+        auto value = std::make_pair(i, static_cast<_Tp>(f));
         ++i;
         return value;
     };
 
-
-
-    std::generate_n(inserter(cntr)
-                , times
-                , make_factorial
-    );
+    generate_sorted(cntr, times, make_factorial);
 }
 
 
 template<typename _Tp, typename _Alloc = std::allocator<_Tp>>
 void fill_cntr(int_list<_Tp, _Alloc>& cntr, int times = 10)
 {
-    auto it = cntr.begin();
-    for(_Tp i = times -1; i >= 0; i-- )
-        cntr.push_front(i);
+    generate_sorted(cntr, times, [i = _Tp{}]() mutable { return i++; });
 }
 
 template<typename _Tp, typename _Compare = std::less<_Tp>,
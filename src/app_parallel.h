@@ -0,0 +1,108 @@
+#pragma once
+
+#include "app_lib.h"
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace app {
+
+namespace impl {
+
+inline unsigned thread_count(unsigned threads, int times)
+{
+    if(0 == threads)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    return std::max(1u, std::min<unsigned>(threads, std::max(times, 1)));
+}
+
+//Runs task(index, begin, end) for every part of [0, times) on its own thread
+//and rethrows the first failure after all threads are joined
+template<typename Task>
+void run_parts(unsigned parts, int times, Task task)
+{
+    std::vector<std::exception_ptr> errors(parts);
+    std::vector<std::thread> workers;
+    workers.reserve(parts);
+
+    for(unsigned part = 0; part < parts; part++)
+    {
+        const auto begin = static_cast<int>(static_cast<long long>(times) * part / parts);
+        const auto end = static_cast<int>(static_cast<long long>(times) * (part + 1) / parts);
+        workers.emplace_back([&task, &errors, part, begin, end]() {
+            try {
+                task(part, begin, end);
+            } catch (...) {
+                errors[part] = std::current_exception();
+            }
+        });
+    }
+    for(auto & worker : workers)
+        worker.join();
+    for(auto & error : errors)
+        if(error)
+            std::rethrow_exception(error);
+}
+
+} //namespace impl
+
+//The map overload runs serially. std::map does not expose its node
+//allocator, so every node is allocated and linked on one thread anyway.
+//Generating and sorting runs on worker threads only added a full copy and
+//merge passes in front of that, and it did not beat generate_sorted. The
+//generator is called with the index in [0, times). Keys out of order are
+//still stored correctly, only not in linear time
+template<typename _Tp, typename _Compare = std::less<_Tp>,
+         typename _Alloc = std::allocator<std::pair<const _Tp, _Tp> >, typename Generator>
+void parallel_generate_sorted(int_map<_Tp, _Alloc, _Compare> & cntr, int times, Generator gen, unsigned /*threads*/ = 0)
+{
+    generate_sorted(cntr, times, [&gen, i = 0]() mutable { return gen(i++); });
+}
+
+//Every thread fills a private list from its own allocator, the lists are
+//then spliced in constant time and their memory pools go to the result
+template<typename _Tp, typename _Alloc = std::allocator<_Tp>, typename Generator>
+void parallel_generate_sorted(int_list<_Tp, _Alloc>& cntr, int times, Generator gen, unsigned threads = 0)
+{
+    const auto parts = impl::thread_count(threads, times);
+
+    std::vector<int_list<_Tp, _Alloc>> lists(parts);
+    impl::run_parts(parts, times, [&lists, &gen](unsigned part, int begin, int end) {
+        if(begin < end)
+            lists[part].generate_front(end - begin, [&gen, i = begin]() mutable { return gen(i++); });
+    });
+
+    for(auto it = lists.rbegin(); it != lists.rend(); ++it)
+        cntr.splice_front(*it);
+}
+
+template<typename _Tp, typename _Compare = std::less<_Tp>,
+         typename _Alloc = std::allocator<std::pair<const _Tp, _Tp> > >
+void parallel_fill_cntr(int_map<_Tp, _Alloc, _Compare> & cntr, int times = 10, unsigned /*threads*/ = 0)
+{
+    fill_cntr(cntr, times);
+}
+
+template<typename _Tp, typename _Alloc = std::allocator<_Tp>>
+void parallel_fill_cntr(int_list<_Tp, _Alloc>& cntr, int times = 10, unsigned threads = 0)
+{
+    parallel_generate_sorted(cntr, times, [](int i) { return static_cast<_Tp>(i); }, threads);
+}
+
+template<typename _Tp, typename _Compare = std::less<_Tp>,
+         typename _Alloc = std::allocator<std::pair<const _Tp, _Tp> > >
+void parallel_fill_and_print(std::ostream &stream, int_map<_Tp, _Alloc, _Compare> && cntr, int times = 10, unsigned threads = 0)
+{
+    parallel_fill_cntr(cntr, times, threads);
+    stream << cntr;
+}
+
+template<typename _Tp, typename _Alloc = std::allocator<_Tp>>
+void parallel_fill_and_print(std::ostream &stream, int_list<_Tp, _Alloc>&& cntr, int times = 10, unsigned threads = 0)
+{
+    parallel_fill_cntr(cntr, times, threads);
+    stream << cntr;
+}
+
+} //namespace app
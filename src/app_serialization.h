@@ -0,0 +1,462 @@
+#pragma once
+
+#include "app_lib.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <unistd.h>
+
+namespace app {
+
+namespace impl {
+
+constexpr const char digit_pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+//Locale independent formatting of an integral value, returns the end of the
+//written characters. The buffer has to fit the longest value of the type
+template<typename T, typename = app::enable_if_integral_t<T>>
+char* format_integral(char* out, T value)
+{
+    using unsigned_t = std::make_unsigned_t<std::conditional_t<std::is_same<std::remove_cv_t<T>, bool>::value, int, T>>;
+    auto magnitude = static_cast<unsigned_t>(value);
+    if(value < T{})
+    {
+        *out++ = '-';
+        magnitude = static_cast<unsigned_t>(unsigned_t{} - magnitude);
+    }
+
+    char digits[std::numeric_limits<unsigned_t>::digits10 + 1];
+    auto * end = digits + sizeof(digits);
+    auto * begin = end;
+    while(magnitude >= 100)
+    {
+        const auto index = static_cast<std::size_t>(magnitude % 100) * 2;
+        magnitude /= 100;
+        *--begin = digit_pairs[index + 1];
+        *--begin = digit_pairs[index];
+    }
+    if(magnitude >= 10)
+    {
+        const auto index = static_cast<std::size_t>(magnitude) * 2;
+        *--begin = digit_pairs[index + 1];
+        *--begin = digit_pairs[index];
+    }
+    else
+        *--begin = static_cast<char>('0' + magnitude);
+
+    return std::copy(begin, end, out);
+}
+
+template<typename T>
+constexpr std::size_t max_formatted_size()
+{
+    return std::numeric_limits<T>::digits10 + 2;
+}
+
+inline bool little_endian()
+{
+    const std::uint16_t value = 1;
+    unsigned char byte;
+    std::memcpy(&byte, &value, 1);
+    return 1 == byte;
+}
+
+constexpr const char binary_magic[] = {'A', 'L', 'C', 'B'};
+constexpr const std::uint8_t binary_version = 1;
+
+enum class binary_kind : std::uint8_t
+{
+    LIST = 1,
+    MAP  = 2
+};
+
+} //namespace impl
+
+//Writes everything to the file descriptor, retrying short writes
+class fd_sink
+{
+public:
+    explicit fd_sink(int fd) : fd_(fd) {}
+
+    void write(const char * data, std::size_t size)
+    {
+        while(size > 0)
+        {
+            const auto written = ::write(fd_, data, size);
+            if(written < 0)
+            {
+                if(EINTR == errno)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "write failed");
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
+private:
+    int fd_;
+};
+
+//Appends to the string, the string storage can be reused between dumps
+class memory_sink
+{
+public:
+    explicit memory_sink(std::string & out) : out_(out) {}
+
+    void write(const char * data, std::size_t size)
+    {
+        out_.append(data, size);
+    }
+private:
+    std::string & out_;
+};
+
+//Collects output in a buffer and passes it to the sink in large blocks.
+//The destructor writes the rest but cannot report errors, so flush() has
+//to be called to see errors of the last block
+template<typename Sink>
+class buffered_writer
+{
+public:
+    static constexpr const std::size_t default_capacity = 64 * 1024;
+
+    explicit buffered_writer(Sink sink, std::size_t capacity = default_capacity)
+        : sink_(std::move(sink)), buffer_(std::max<std::size_t>(capacity, 64)) {}
+    buffered_writer(buffered_writer&& value)
+        : sink_(std::move(value.sink_)), buffer_(std::move(value.buffer_)), size_(value.size_)
+    {
+        value.size_ = 0;
+    }
+    buffered_writer(const buffered_writer&) = delete;
+    buffered_writer& operator=(const buffered_writer&) = delete;
+    //Errors of the final write are dropped here, see flush()
+    ~buffered_writer()
+    {
+        try {
+            flush();
+        } catch (...) {
+        }
+    }
+
+    void write(const char * data, std::size_t size)
+    {
+        if(size > buffer_.size() - size_)
+        {
+            flush();
+            if(size >= buffer_.size())
+            {
+                sink_.write(data, size);
+                return;
+            }
+        }
+        std::memcpy(buffer_.data() + size_, data, size);
+        size_ += size;
+    }
+
+    void put(char value)
+    {
+        reserve(1);
+        buffer_[size_++] = value;
+    }
+
+    template<typename T>
+    void write_integral(T value)
+    {
+        reserve(impl::max_formatted_size<T>());
+        size_ = impl::format_integral(buffer_.data() + size_, value) - buffer_.data();
+    }
+
+    //Stores the value bytes as they are in memory
+    template<typename T>
+    void write_raw(const T & value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written raw");
+        reserve(sizeof(T));
+        std::memcpy(buffer_.data() + size_, &value, sizeof(T));
+        size_ += sizeof(T);
+    }
+
+    void flush()
+    {
+        if(0 == size_)
+            return;
+        const auto size = size_;
+        size_ = 0;
+        sink_.write(buffer_.data(), size);
+    }
+
+private:
+    void reserve(std::size_t size)
+    {
+        if(size > buffer_.size() - size_)
+            flush();
+    }
+
+    Sink                sink_;
+    std::vector<char>   buffer_;
+    std::size_t         size_ = 0;
+};
+
+template<typename Sink>
+auto make_writer(Sink sink, std::size_t capacity = buffered_writer<Sink>::default_capacity)
+{
+    return buffered_writer<Sink>(std::move(sink), capacity);
+}
+
+//Reads from the file descriptor until the requested size or end of file
+class fd_source
+{
+public:
+    explicit fd_source(int fd) : fd_(fd) {}
+
+    std::size_t read(char * data, std::size_t size)
+    {
+        std::size_t total = 0;
+        while(total < size)
+        {
+            const auto received = ::read(fd_, data + total, size - total);
+            if(received < 0)
+            {
+                if(EINTR == errno)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "read failed");
+            }
+            if(0 == received)
+                break;
+            total += static_cast<std::size_t>(received);
+        }
+        return total;
+    }
+private:
+    int fd_;
+};
+
+class memory_source
+{
+public:
+    memory_source(const char * data, std::size_t size) : data_(data), size_(size) {}
+    explicit memory_source(const std::string & data) : memory_source(data.data(), data.size()) {}
+
+    std::size_t read(char * data, std::size_t size)
+    {
+        size = std::min(size, size_);
+        std::memcpy(data, data_, size);
+        data_ += size;
+        size_ -= size;
+        return size;
+    }
+private:
+    const char * data_;
+    std::size_t  size_;
+};
+
+template<typename Source>
+class buffered_reader
+{
+public:
+    static constexpr const std::size_t default_capacity = 64 * 1024;
+
+    explicit buffered_reader(Source source, std::size_t capacity = default_capacity)
+        : source_(std::move(source)), buffer_(std::max<std::size_t>(capacity, 64)) {}
+
+    void read(char * data, std::size_t size)
+    {
+        while(size > 0)
+        {
+            if(position_ == size_ && !fill())
+                throw std::runtime_error("Unexpected end of data");
+            const auto chunk = std::min(size, size_ - position_);
+            std::memcpy(data, buffer_.data() + position_, chunk);
+            position_ += chunk;
+            data += chunk;
+            size -= chunk;
+        }
+    }
+
+    template<typename T>
+    T read_raw()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read raw");
+        T value;
+        read(reinterpret_cast<char*>(&value), sizeof(T));
+        return value;
+    }
+
+private:
+    bool fill()
+    {
+        position_ = 0;
+        size_ = source_.read(buffer_.data(), buffer_.size());
+        return 0 != size_;
+    }
+
+    Source              source_;
+    std::vector<char>   buffer_;
+    std::size_t         position_ = 0;
+    std::size_t         size_ = 0;
+};
+
+template<typename Source>
+auto make_reader(Source source, std::size_t capacity = buffered_reader<Source>::default_capacity)
+{
+    return buffered_reader<Source>(std::move(source), capacity);
+}
+
+//Text dump, same format as the stream operators
+template<typename Sink, typename _Tp, typename _Compare = std::less<_Tp>,
+         typename _Alloc = std::allocator<std::pair<const _Tp, _Tp> >>
+void write_text(buffered_writer<Sink> & writer, const int_map<_Tp, _Alloc, _Compare> & cntr)
+{
+    for (const auto& p: cntr)
+    {
+        writer.write_integral(p.first);
+        writer.put(' ');
+        writer.write_integral(p.second);
+        writer.put('\n');
+    }
+}
+
+template<typename Sink, typename _Tp, typename _Alloc = std::allocator<_Tp>>
+void write_text(buffered_writer<Sink> & writer, int_list<_Tp, _Alloc>& cntr)
+{
+    for (const auto& p: cntr)
+    {
+        writer.write_integral(p);
+        writer.put('\n');
+    }
+}
+
+namespace impl {
+
+//Number of list values read from a binary dump before memory for the next
+//ones is reserved
+constexpr std::uint64_t binary_block_size = 64 * 1024;
+
+template<typename Sink, typename T>
+void write_binary_header(buffered_writer<Sink> & writer, binary_kind kind, std::uint64_t count)
+{
+    writer.write(binary_magic, sizeof(binary_magic));
+    writer.write_raw(binary_version);
+    writer.write_raw(static_cast<std::uint8_t>(kind));
+    writer.write_raw(static_cast<std::uint8_t>(sizeof(T)));
+    writer.write_raw(static_cast<std::uint8_t>(little_endian()));
+    writer.write_raw(count);
+}
+
+template<typename T, typename Source>
+std::uint64_t read_binary_header(buffered_reader<Source> & reader, binary_kind kind)
+{
+    char magic[sizeof(binary_magic)];
+    reader.read(magic, sizeof(magic));
+    if(0 != std::memcmp(magic, binary_magic, sizeof(magic)))
+        throw std::runtime_error("Not a binary container dump");
+    if(binary_version != reader.template read_raw<std::uint8_t>())
+        throw std::runtime_error("Unsupported binary dump version");
+    if(static_cast<std::uint8_t>(kind) != reader.template read_raw<std::uint8_t>())
+        throw std::runtime_error("Binary dump holds another container kind");
+    if(sizeof(T) != reader.template read_raw<std::uint8_t>())
+        throw std::runtime_error("Binary dump holds another value type");
+    if(static_cast<std::uint8_t>(little_endian()) != reader.template read_raw<std::uint8_t>())
+        throw std::runtime_error("Binary dump has another byte order");
+    return reader.template read_raw<std::uint64_t>();
+}
+
+} //namespace impl
+
+//Binary dump: header with magic, version, container kind, value size,
+//byte order and element count followed by raw values in container order
+template<typename Sink, typename _Tp, typename _Compare = std::less<_Tp>,
+         typename _Alloc = std::allocator<std::pair<const _Tp, _Tp> >>
+void write_binary(buffered_writer<Sink> & writer, const int_map<_Tp, _Alloc, _Compare> & cntr)
+{
+    impl::write_binary_header<Sink, _Tp>(writer, impl::binary_kind::MAP, cntr.size());
+    for (const auto& p: cntr)
+    {
+        writer.write_raw(p.first);
+        writer.write_raw(p.second);
+    }
+}
+
+template<typename Sink, typename _Tp, typename _Alloc = std::allocator<_Tp>>
+void write_binary(buffered_writer<Sink> & writer, int_list<_Tp, _Alloc>& cntr)
+{
+    //The list does not track its size, so the count is taken before writing
+    std::uint64_t count = 0;
+    for (auto it = cntr.begin(); it != cntr.end(); ++it)
+        count++;
+
+    impl::write_binary_header<Sink, _Tp>(writer, impl::binary_kind::LIST, count);
+    for (const auto& p: cntr)
+        writer.write_raw(p);
+}
+
+//Loads the binary dump through the bulk-load path. Keys of the dumped map
+//have to be greater than the keys already stored for linear time loading.
+//The dump is loaded into a temporary map, so a corrupt or truncated dump
+//leaves the container unchanged. An empty container takes the loaded map
+//in constant time when the allocators are interchangeable, otherwise the
+//values are copied
+template<typename Source, typename _Tp, typename _Compare = std::less<_Tp>,
+         typename _Alloc = std::allocator<std::pair<const _Tp, _Tp> >>
+void read_binary(buffered_reader<Source> & reader, int_map<_Tp, _Alloc, _Compare> & cntr)
+{
+    const auto count = impl::read_binary_header<_Tp>(reader, impl::binary_kind::MAP);
+    if(count > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+        throw std::runtime_error("Binary dump is too large");
+
+    int_map<_Tp, _Alloc, _Compare> loaded;
+    generate_sorted(loaded, static_cast<int>(count), [&reader]() {
+        const auto key = reader.template read_raw<_Tp>();
+        return std::make_pair(key, reader.template read_raw<_Tp>());
+    });
+    using allocator_traits = std::allocator_traits<typename int_map<_Tp, _Alloc, _Compare>::allocator_type>;
+    if(cntr.empty() && allocator_traits::is_always_equal::value)
+        cntr.swap(loaded);
+    else
+        load_sorted(cntr, loaded.begin(), loaded.end());
+}
+
+//The count in the header is not trusted for the memory reservation. The
+//values are loaded in blocks of bounded size, so a corrupt count fails with
+//the end of data instead of reserving memory for all elements up front.
+//The blocks are spliced in front of the list once all of them are read
+template<typename Source, typename _Tp, typename _Alloc = std::allocator<_Tp>>
+void read_binary(buffered_reader<Source> & reader, int_list<_Tp, _Alloc>& cntr)
+{
+    const auto count = impl::read_binary_header<_Tp>(reader, impl::binary_kind::LIST);
+    if(count > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+        throw std::runtime_error("Binary dump is too large");
+
+    std::list<int_list<_Tp, _Alloc>> blocks;
+    for(auto remaining = count; remaining > 0; )
+    {
+        const auto size = std::min(remaining, impl::binary_block_size);
+        blocks.emplace_back();
+        generate_sorted(blocks.back(), static_cast<int>(size), [&reader]() {
+            return reader.template read_raw<_Tp>();
+        });
+        remaining -= size;
+    }
+    for(auto it = blocks.rbegin(); it != blocks.rend(); ++it)
+        cntr.splice_front(*it);
+}
+
+} //namespace app
@@ -5,13 +5,25 @@
 #include <vector>
 #include <bitset>
 #include <array>
+#include <atomic>
 #include <list>
 #include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <limits>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
 
 namespace allocator {
 
 
+//What happens to a chunk that gets empty. NONE keeps it for reuse, LIFO and
+//FIFO free it. LIFO and FIFO are aliases kept for compatibility, they only
+//differed in the direction of the search for the chunk in the pool
 enum class memory_strategy
 {
     NONE,
@@ -19,137 +31,563 @@ enum class memory_strategy
     FIFO
 };
 
+//Order in which cells of a chunk are given out. Lists filled one element at
+//a time with push_front get their nodes in traversal order with DESCENDING,
+//so iteration walks the memory forward. Bulk fills with push_front(first,
+//last) and generate_front (fill_cntr, load_sorted) allocate the nodes in
+//traversal order, so with DESCENDING their memory is walked backwards
+enum class allocation_order
+{
+    ASCENDING,
+    DESCENDING
+};
+
+//What deallocate verifies. TRUSTED takes the chunk stored in the cell as it
+//is. CHECKED looks the chunk up in a table of the chunks owned by the
+//allocator and tests the occupancy bit of the cell, a pointer of another
+//allocator or a double free throws std::invalid_argument
+enum class deallocation_check
+{
+    TRUSTED,
+    CHECKED
+};
+
 namespace impl {
 
+//Every chunk knows its position in the pool, so the empty chunk is
+//released in constant time. LIFO and FIFO share this implementation
 template<memory_strategy Strategy, typename List, typename NodeManager>
 struct remove_block{
-    void operator()(List &, const NodeManager * const){}
+    template<typename Release>
+    void operator()(List& list, NodeManager * const ptr, Release release){
+        if(nullptr == ptr)
+            throw std::runtime_error("nullptr");
+        release(list, ptr->position);
+    }
 };
 
 template<typename List, typename NodeManager>
-struct remove_block<memory_strategy::LIFO, List, NodeManager> {
-    void operator()(List& list, const NodeManager * const ptr){
-        if(nullptr == ptr)
-            throw std::runtime_error("nullptr");
-        auto it = list.begin(), end = list.end();
-        for( ; it != end; it++)
-        {
-            if((*it).get() == ptr)
-            {
-                list.erase(it);
-                break;
-            }
+struct remove_block<memory_strategy::NONE, List, NodeManager> {
+    template<typename Release>
+    void operator()(List &, NodeManager * const, Release){}
+};
 
-        }
+//Addresses of the chunks owned by one allocator. Checked deallocation looks
+//the chunk of a pointer up here before it trusts the manager stored in the
+//cell. The lookup is a hash probe, so the check stays constant time
+template<deallocation_check Check, typename NodeManager>
+class chunk_table
+{
+public:
+    void insert(const NodeManager * ptr) { chunks_.insert(ptr); }
+    void erase(const NodeManager * ptr) { chunks_.erase(ptr); }
+    void clear() { chunks_.clear(); }
+    void merge(chunk_table & other) {
+        chunks_.insert(other.chunks_.begin(), other.chunks_.end());
+        other.chunks_.clear();
     }
+    bool contains(const NodeManager * ptr) const { return 0 != chunks_.count(ptr); }
+private:
+    std::unordered_set<const NodeManager *> chunks_;
 };
 
-template<typename List, typename NodeManager>
-struct remove_block<memory_strategy::FIFO, List, NodeManager> {
-    void operator()(List& list, const NodeManager * const  ptr){
-        if(nullptr == ptr)
-            throw std::runtime_error("nullptr");
-        auto it = list.rbegin(), end = list.rend();
-        for( ; it != end; it++)
+//Trusted deallocation keeps no table and accepts every chunk
+template<typename NodeManager>
+class chunk_table<deallocation_check::TRUSTED, NodeManager>
+{
+public:
+    void insert(const NodeManager *) {}
+    void erase(const NodeManager *) {}
+    void clear() {}
+    void merge(chunk_table &) {}
+    bool contains(const NodeManager *) const { return true; }
+};
+
+
+}
+
+//Chunk cache policies. Chunks an allocator does not need anymore are given
+//to the cache and new allocators of the same type take them from it
+
+//Chunks are released to the heap immediately
+struct no_chunk_cache
+{
+    template<typename Pool>
+    struct cache
+    {
+        static bool acquire(Pool &) { return false; }
+        static void release(Pool & pool, typename Pool::iterator it) { pool.erase(it); }
+        static void release_all(Pool & pool) { pool.clear(); }
+        static void trim() {}
+    };
+
+    static void trim() {}
+};
+
+//Empty chunks are kept in a thread local cache of up to LocalLimit chunks.
+//The overflow goes to a process wide cache of up to GlobalLimit chunks that
+//is shared between threads. Chunks are moved between the pools with list
+//splicing, so in steady state creating and destroying a container does not
+//touch the heap
+template<std::size_t LocalLimit = 8, std::size_t GlobalLimit = 64>
+struct recycled_chunk_cache
+{
+private:
+    //Caches of all allocator types that use this policy, linked without
+    //heap allocations
+    struct registration
+    {
+        void (*trim)();
+        registration * next;
+    };
+    static std::mutex & registry_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+    static registration *& registry() {
+        static registration * head = nullptr;
+        return head;
+    }
+public:
+    //Frees cached chunks of all allocator types, the thread local caches
+    //are freed only for the calling thread
+    static void trim() {
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        for(auto * item = registry(); nullptr != item; item = item->next)
+            item->trim();
+    }
+
+    template<typename Pool>
+    struct cache
+    {
+        static bool acquire(Pool & pool) {
+            auto * cached = local();
+            if(nullptr == cached)
+                return false;
+            if(cached->empty())
+                if(auto * shared = global())
+                {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    //Take a half of the local limit at once, so the lock is not
+                    //taken for every chunk
+                    auto count = std::min(shared->pool.size(), std::max<std::size_t>(LocalLimit / 2, 1));
+                    auto last = shared->pool.begin();
+                    std::advance(last, count);
+                    cached->splice(cached->end(), shared->pool, shared->pool.begin(), last);
+                }
+            if(cached->empty())
+                return false;
+            pool.splice(pool.end(), *cached, cached->begin());
+            return true;
+        }
+        static void release(Pool & pool, typename Pool::iterator it) {
+            auto * cached = (*it)->empty() ? local() : nullptr;
+            if(nullptr == cached)
+            {
+                pool.erase(it);
+                return;
+            }
+            cached->splice(cached->begin(), pool, it);
+            if(cached->size() > LocalLimit)
+                spill(*cached);
+        }
+        //The caches hold at most LocalLimit + GlobalLimit chunks, so only that
+        //many chunks with used cells are reset, the rest is freed without
+        //touching the cells
+        static void release_all(Pool & pool) {
+            for(std::size_t kept = 0; !pool.empty() && kept < LocalLimit + GlobalLimit; kept++)
+            {
+                pool.front()->reset();
+                release(pool, pool.begin());
+            }
+            pool.clear();
+        }
+        //Frees cached chunks of the calling thread and the shared ones
+        static void trim() {
+            if(auto * cached = local())
+                cached->clear();
+            if(auto * shared = global())
+            {
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                shared->pool.clear();
+            }
+        }
+    private:
+        //The caches are destroyed at thread or program exit before
+        //containers with static storage that were created earlier. The
+        //state outlives the caches, so such containers free their chunks
+        //directly instead of using a destroyed cache
+        enum class pool_state : unsigned char
+        {
+            FRESH,
+            ALIVE,
+            DESTROYED
+        };
+        struct local_pool
+        {
+            local_pool() { local_state() = pool_state::ALIVE; }
+            ~local_pool() {
+                pool.clear();
+                local_state() = pool_state::DESTROYED;
+            }
+            Pool pool;
+        };
+        struct shared_pool
         {
-            if((*it).get() == ptr)
+            shared_pool() { global_state() = pool_state::ALIVE; }
+            ~shared_pool() {
+                pool.clear();
+                global_state() = pool_state::DESTROYED;
+            }
+            std::mutex mutex;
+            Pool pool;
+        };
+        static pool_state & local_state() {
+            thread_local pool_state state = pool_state::FRESH;
+            return state;
+        }
+        static pool_state & global_state() {
+            static pool_state state = pool_state::FRESH;
+            return state;
+        }
+        static Pool * local() {
+            if(pool_state::DESTROYED == local_state())
+                return nullptr;
+            thread_local local_pool cached;
+            return &cached.pool;
+        }
+        static shared_pool * global() {
+            if(pool_state::DESTROYED == global_state())
+                return nullptr;
+            static shared_pool shared;
+            static const bool registered = add_registration();
+            (void)registered;
+            return &shared;
+        }
+        static bool add_registration() {
+            static registration item{&cache::trim, nullptr};
+            std::lock_guard<std::mutex> lock(registry_mutex());
+            item.next = registry();
+            registry() = &item;
+            return true;
+        }
+        static void spill(Pool & cached) {
+            auto first = cached.begin();
+            std::advance(first, LocalLimit / 2);
+            if(auto * shared = global())
             {
-                list.erase(std::next(it).base());
-                break;
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                while(first != cached.end() && shared->pool.size() < GlobalLimit)
+                    shared->pool.splice(shared->pool.end(), cached, first++);
             }
-
+            cached.erase(first, cached.end());
         }
+    };
+};
+
+namespace impl {
+
+constexpr const size_t byte_budget_flag = size_t(1) << (sizeof(size_t) * CHAR_BIT - 1);
+
+constexpr bool is_power_of_two(size_t value)
+{
+    return 0 != value && 0 == (value & (value - 1));
+}
+
+constexpr size_t round_up(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+constexpr size_t round_up_power_of_two(size_t value)
+{
+    size_t result = 1;
+    while(result < value)
+        result <<= 1;
+    return result;
+}
+
+//Memory for chunks. Before C++17 operator new ignores extended alignment,
+//so over-aligned chunks are taken directly from posix_memalign
+template<size_t Alignment>
+struct chunk_memory
+{
+    static constexpr const bool over_aligned = Alignment > alignof(std::max_align_t);
+
+    static void * allocate(size_t size) {
+        if(!over_aligned)
+            return ::operator new(size);
+        void * ptr = nullptr;
+        if(0 != posix_memalign(&ptr, Alignment, size))
+            throw std::bad_alloc();
+        return ptr;
     }
+    static void deallocate(void * ptr) noexcept {
+        if(!over_aligned)
+            ::operator delete(ptr);
+        else
+            std::free(ptr);
+    }
+};
+
+}
+
+//Process wide counters of all chunk allocators. They are collected only
+//when ALLOCATOR_STATISTICS is defined, otherwise they stay zero
+struct chunk_statistics
+{
+    size_t chunks = 0;          //Chunks that exist, cached ones included
+    size_t reserved_bytes = 0;  //Memory taken by these chunks
+    size_t live_cells = 0;      //Cells given out and not released
+    size_t live_bytes = 0;      //Size of the objects in these cells
 };
 
+namespace impl {
+
+struct statistics_counters
+{
+    std::atomic<size_t> chunks{0};
+    std::atomic<size_t> reserved_bytes{0};
+    std::atomic<size_t> live_cells{0};
+    std::atomic<size_t> live_bytes{0};
+};
+
+inline statistics_counters & counters()
+{
+    static statistics_counters instance;
+    return instance;
+}
+
+inline void count_chunks(long chunks, size_t footprint)
+{
+#ifdef ALLOCATOR_STATISTICS
+    auto & instance = counters();
+    instance.chunks.fetch_add(chunks, std::memory_order_relaxed);
+    instance.reserved_bytes.fetch_add(chunks * footprint, std::memory_order_relaxed);
+#else
+    (void)chunks;
+    (void)footprint;
+#endif
+}
+
+inline void count_cells(long cells, size_t cell_size)
+{
+#ifdef ALLOCATOR_STATISTICS
+    auto & instance = counters();
+    instance.live_cells.fetch_add(cells, std::memory_order_relaxed);
+    instance.live_bytes.fetch_add(cells * cell_size, std::memory_order_relaxed);
+#else
+    (void)cells;
+    (void)cell_size;
+#endif
+}
 
 }
 
-template <typename T, size_t Size = 10, memory_strategy Strategy=memory_strategy::NONE >
+inline chunk_statistics statistics()
+{
+    auto & instance = impl::counters();
+    chunk_statistics result;
+    result.chunks = instance.chunks.load(std::memory_order_relaxed);
+    result.reserved_bytes = instance.reserved_bytes.load(std::memory_order_relaxed);
+    result.live_cells = instance.live_cells.load(std::memory_order_relaxed);
+    result.live_bytes = instance.live_bytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+//Chunk size given as a byte budget instead of a number of elements, e.g.
+//chunk_allocator<int, chunk_bytes(4096)>. The chunk holds as many elements
+//as fit in the budget together with the chunk header. A power of two
+//budget is also the alignment of the chunk, so chunks line up with pages
+constexpr size_t chunk_bytes(size_t bytes)
+{
+    return bytes | impl::byte_budget_flag;
+}
+
+template <typename T, size_t Size = 10, memory_strategy Strategy=memory_strategy::NONE, typename Cache = no_chunk_cache,
+          allocation_order Order = allocation_order::ASCENDING, deallocation_check Check = deallocation_check::TRUSTED >
 class chunk_allocator {
-   static_assert(Size > 1, "The chunk size should be at least 2 * 8 elements");
+   static constexpr const bool Byte_budget = 0 != (Size & impl::byte_budget_flag);
+   static constexpr const size_t Budget = Size & ~impl::byte_budget_flag;
+   static_assert(Byte_budget || Size > 1, "The chunk size should be at least 2 * 8 elements");
 public:
    using value_type = T;
    using pointer = T *;
    using size_type = size_t;
 
 private:
+   //Cells hold raw storage, objects are constructed and destroyed by the
+   //container, so a chunk never runs destructors of the objects again
    template <typename Manager>
    struct node
    {
-       T data;
+       typename std::aligned_storage<sizeof(T), alignof(T)>::type data;
        bool used = false;
        Manager * manager = nullptr;
    };
-   //Define types in specialization
-   static constexpr const auto Chunk_size = Size * CHAR_BIT;   
+
+   class node_manager;
+   struct chunk_deleter
+   {
+       void operator()(node_manager * ptr) const noexcept;
+   };
+   using pool_t =   std::list<std::unique_ptr<node_manager, chunk_deleter>>;
+   using node_t = node<node_manager>;
+
+   static constexpr const size_t Max_cells = Byte_budget ? Budget / sizeof(node_t) : Size * CHAR_BIT;
+   using counter_t = std::conditional_t<(Max_cells < std::numeric_limits<unsigned short>::max()), unsigned short, unsigned>;
+
+   //Bookkeeping placed in front of the cells
+   struct chunk_header
+   {
+       //Position of the chunk in the pool. List splicing keeps it valid when
+       //the chunk moves between pools
+       typename pool_t::iterator position;
+       counter_t usage_counter = 0;
+       //Lowest slot that may be free for ascending order, one past the
+       //highest one for descending order
+       counter_t next_free = 0;
+   };
+
+   static constexpr const size_t Header_size = impl::round_up(sizeof(chunk_header), alignof(node_t));
+   static constexpr const size_t Chunk_size = !Byte_budget ? Size * CHAR_BIT :
+                                              Budget > Header_size ? (Budget - Header_size) / sizeof(node_t) : 0;
+   static_assert(!Byte_budget || Chunk_size > 1, "The byte budget should fit at least 2 elements");
+
+   //Power of two budgets align chunks to the budget, over-aligned types get
+   //at least cache line alignment. Checked allocators align chunks to their
+   //size rounded up to a power of two, so masking the address of a cell
+   //gives the start of its chunk
+   static constexpr const size_t Natural_alignment = std::max(alignof(chunk_header), alignof(node_t));
+   static constexpr const size_t Chunk_alignment = std::max({Natural_alignment,
+           Byte_budget && impl::is_power_of_two(Budget) ? Budget : size_t(1),
+           alignof(node_t) > alignof(std::max_align_t) ? std::max<size_t>(64, alignof(node_t)) : size_t(1),
+           deallocation_check::CHECKED == Check ?
+               impl::round_up_power_of_two(impl::round_up(Header_size + Chunk_size * sizeof(node_t), Natural_alignment)) :
+               size_t(1)});
+
    //Managers allocated memory chunk
-   class node_manager
+   class node_manager : public chunk_header
    {
 
    public:
-       using node_t = node<node_manager>;
        using node_array_t =  std::array<node_t, Chunk_size> ;
+       using chunk_header::usage_counter;
+       using chunk_header::next_free;
 
        node_manager()
        {
-
-           for(auto i = 0; i < Chunk_size; i++)
+           next_free = first_free;
+           for(size_t i = 0; i < Chunk_size; i++)
                memory[i].manager = this;
+           impl::count_chunks(1, sizeof(node_manager));
+       }
+       ~node_manager()
+       {
+           impl::count_cells(-static_cast<long>(usage_counter), sizeof(T));
+           impl::count_chunks(-1, sizeof(node_manager));
        }
        bool operator==(const node_manager& value) {return *this == value;}
        pointer use_free_block(){
-           auto i = 0, j = 0;
-           for(auto & item : memory)
-                if(!item.used)
+           //Slots on the used side of next_free are known to be used, so
+           //consecutive allocations from the same chunk do not rescan it
+           if(allocation_order::ASCENDING == Order)
+           {
+               for(auto i = next_free; i < Chunk_size; i++)
+                   if(!memory[i].used)
+                   {
+                       next_free = i + 1;
+                       return use(memory[i]);
+                   }
+               next_free = Chunk_size;
+           }
+           else
+           {
+               for(auto i = next_free; i > 0; i--)
+                   if(!memory[i - 1].used)
                    {
-                        item.used = true;
-                        pointer result = &item.data;
-                        usage_counter++;
-                        return result;
+                       next_free = i - 1;
+                       return use(memory[i - 1]);
                    }
+               next_free = 0;
+           }
            return nullptr;
        }
+       //Whether the pointer is the start of one of the cells of the chunk
+       bool owns(const void * ptr) const {
+           const auto first = reinterpret_cast<std::uintptr_t>(&memory[0]);
+           const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+           return address >= first && address - first < sizeof(node_array_t) &&
+                  0 == (address - first) % sizeof(node_t);
+       }
+       //Returns false for a cell that is not in the chunk or is free already,
+       //so a double free does not drive the usage counter below zero
        bool free_block(node_t * ptr){
            if(nullptr == ptr)
                throw std::runtime_error("nullptr");
-           if(ptr >= &(memory[0]) && ptr <= &(memory[memory.size()-1]))
+           if(ptr >= &(memory[0]) && ptr <= &(memory[memory.size()-1]) && ptr->used)
            {
             ptr->used = false;
             usage_counter--;
+            impl::count_cells(-1, sizeof(T));
+            const counter_t index = ptr - &(memory[0]);
+            if(allocation_order::ASCENDING == Order)
+                next_free = std::min(next_free, index);
+            else
+                next_free = std::max<counter_t>(next_free, index + 1);
             return  true;
            }
            return false;
        }
+       size_type free_count() const {
+           return Chunk_size - usage_counter;
+       }
        bool has_free() {
            return Chunk_size > usage_counter;
        }
        bool empty() {
            return 0 == usage_counter;
        }
+       //Marks all cells free without looking at them one by one
+       void reset() {
+           for(auto & item : memory)
+               item.used = false;
+           impl::count_cells(-static_cast<long>(usage_counter), sizeof(T));
+           usage_counter = 0;
+           next_free = first_free;
+       }
 
    private:
        node_array_t memory;
-       unsigned short usage_counter = 0; //Number of items is limited by this type
-       static_assert(Chunk_size < std::numeric_limits<unsigned short>::max(), "Cannot be larger than unsigned short" );
+       static constexpr const counter_t first_free = allocation_order::ASCENDING == Order ? 0 : Chunk_size;
+
+       pointer use(node_t & item) {
+           item.used = true;
+           usage_counter++;
+           impl::count_cells(1, sizeof(T));
+           return reinterpret_cast<pointer>(&item.data);
+       }
    };
 
 
+   static_assert(deallocation_check::CHECKED != Check || sizeof(node_manager) <= Chunk_alignment,
+                 "Checked chunks have to fit their alignment");
+
 public:
    template<typename U>
    struct rebind
    {
-       using other = chunk_allocator<U, Size, Strategy>;
+       using other = chunk_allocator<U, Size, Strategy, Cache, Order, Check>;
    };
 
 
 
    chunk_allocator() = default;
    ~chunk_allocator(){
-    pool_.clear();
+    cache_t::release_all(pool_);
    }
 
-   template <class U> chunk_allocator (const chunk_allocator<U>&) noexcept {}
+   template <class U> chunk_allocator (const chunk_allocator<U, Size, Strategy, Cache, Order, Check>&) noexcept {}
    pointer allocate (std::size_t n) {
 
      if(n > 1)
@@ -158,37 +596,141 @@ public:
     return get_free_block();
   }
 
+  //Makes sure that next n allocations are served without growing the pool.
+  //The missing chunks are created at once, so bulk loads do not interleave
+  //chunk creation with element construction. Chunks with free cells are at
+  //the end of the pool, so only these are visited and the walk stops as soon
+  //as they hold n cells
+  void reserve(size_type n) {
+      size_type available = 0;
+      for(auto it = pool_.rbegin(); it != pool_.rend() && available < n && (*it)->has_free(); ++it)
+          available += (*it)->free_count();
+      for( ; available < n; available += Chunk_size)
+          add_block();
+  }
+
+  //Number of elements in one chunk
+  static constexpr size_type chunk_capacity() {
+      return Chunk_size;
+  }
+  //Memory taken by one chunk including its header
+  static constexpr size_type chunk_footprint() {
+      return sizeof(node_manager);
+  }
+  static constexpr size_type chunk_alignment() {
+      return Chunk_alignment;
+  }
+
+  //Frees the chunks kept by the cache of this allocator type
+  static void trim_cache() {
+      cache_t::trim();
+  }
+
+  //Takes over all chunks of the other allocator. Memory allocated by the
+  //other allocator can be released through this one afterwards
+  void merge(chunk_allocator& other) {
+      if(this != &other)
+      {
+          //Chunks with free cells are at the end of the other pool as well
+          auto first_free = other.pool_.end();
+          while(first_free != other.pool_.begin() && (*std::prev(first_free))->has_free())
+              --first_free;
+          pool_.splice(pool_.end(), other.pool_, first_free, other.pool_.end());
+          pool_.splice(pool_.begin(), other.pool_);
+          chunks_.merge(other.chunks_);
+      }
+  }
+
 
   void deallocate (pointer p, std::size_t n) {
       if(n > 1)
            throw std::invalid_argument( "Currently allocator supports only single cell allocation" );
 
-      auto * ptr = reinterpret_cast<typename node_manager::node_t*>(p);
-      ptr->manager->free_block(ptr);
-      if(ptr->manager->empty())
-            impl::remove_block<Strategy, pool_t, node_manager>{}(pool_, ptr->manager);
+      free_block(p);
+  }
+
+  //Drops all chunks at once without releasing the cells one by one. The
+  //objects in the cells have to be destroyed before, all pointers given by
+  //the allocator get invalid. Only chunks kept by the cache are reset
+  void release_all() {
+      chunks_.clear();
+      cache_t::release_all(pool_);
   }
 
 private:
+  //Full chunks are kept at the head of the pool and chunks with free cells
+  //at its end, so only the last chunk has to be checked
   pointer get_free_block() {
-    //Try to find the first available block;
-      if(pool_.size())
-          {
-              auto it = pool_.rbegin(), end = pool_.rend();
-              for( ; it != end; it++)
-              {
-                  if((*it)->has_free())
-                      return (*it)->use_free_block();
-              }
-          }
-          pool_.push_back(std::make_unique<node_manager>());
-          return pool_.back()->use_free_block();
+      if(pool_.empty() || !pool_.back()->has_free())
+          add_block();
+      return use_block(std::prev(pool_.end()));
+  }
+
+  void add_block() {
+      if(!cache_t::acquire(pool_))
+      {
+          static_assert(!Byte_budget || sizeof(node_manager) <= Budget, "The chunk does not fit the byte budget");
+          auto * memory = impl::chunk_memory<Chunk_alignment>::allocate(sizeof(node_manager));
+          pool_.push_back(typename pool_t::value_type(new (memory) node_manager()));
+          pool_.back()->position = std::prev(pool_.end());
+      }
+      chunks_.insert(pool_.back().get());
+  }
+
+  //Checked allocators find the chunk of a pointer by masking its address and
+  //look it up in the chunk table. Nothing is read from memory that is not a
+  //live chunk of this allocator, so pointers of another allocator and cells
+  //of released chunks are rejected safely. The occupancy bit of a cell in a
+  //live chunk catches double frees
+  node_manager * owner(pointer p) const {
+      const auto address = reinterpret_cast<std::uintptr_t>(p);
+      auto * manager = reinterpret_cast<node_manager*>(address & ~std::uintptr_t(Chunk_alignment - 1));
+      if(nullptr == p || !chunks_.contains(manager) || !manager->owns(p))
+          throw std::invalid_argument("Pointer was not allocated by this allocator");
+      return manager;
+  }
+
+  void free_block(pointer p) {
+      auto * ptr = reinterpret_cast<node_t*>(p);
+      auto * manager = deallocation_check::CHECKED == Check ? owner(p) : ptr->manager;
+      if(!manager->free_block(ptr))
+      {
+          if(deallocation_check::CHECKED == Check)
+              throw std::invalid_argument("Pointer is released twice");
+          return;
+      }
+      //A chunk that was full gets a free cell and joins the chunks at the end
+      if(1 == manager->free_count())
+          pool_.splice(pool_.end(), pool_, manager->position);
+      if(manager->empty())
+            impl::remove_block<Strategy, pool_t, node_manager>{}(pool_, manager,
+                [this](pool_t & pool, typename pool_t::iterator it) {
+                    chunks_.erase(it->get());
+                    cache_t::release(pool, it);
+                });
+  }
+
+  //Full chunks are moved to the head of the pool
+  template<typename Iterator>
+  pointer use_block(Iterator it) {
+      auto result = (*it)->use_free_block();
+      if(!(*it)->has_free())
+          pool_.splice(pool_.begin(), pool_, it);
+      return result;
   }
 private:  
-    using pool_t =   std::list<std::unique_ptr<node_manager>>;
+    using cache_t = typename Cache::template cache<pool_t>;
     pool_t pool_;
+    impl::chunk_table<Check, node_manager> chunks_;
 
 
 };
 
+template <typename T, size_t Size, memory_strategy Strategy, typename Cache, allocation_order Order, deallocation_check Check>
+void chunk_allocator<T, Size, Strategy, Cache, Order, Check>::chunk_deleter::operator()(node_manager * ptr) const noexcept
+{
+    ptr->~node_manager();
+    impl::chunk_memory<Chunk_alignment>::deallocate(ptr);
+}
+
 } //namespace allocator
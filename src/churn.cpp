@@ -0,0 +1,433 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "chunk_allocator.h"
+#include "app_lib.h"
+
+//Long running allocation churn against linked_list and std::map with
+//chunk_allocator. Containers are created with a size and a lifetime taken from
+//configurable distributions, live containers erase and insert part of their
+//elements every tick. Memory use is sampled periodically and written as a CSV
+//time series. Every container and strategy pair runs in its own process, so
+//the RSS of one run does not carry over to the next one
+
+namespace {
+
+//Distribution given on the command line as name:arg:arg...
+//  fixed:N               always N
+//  uniform:A:B           uniform in [A, B]
+//  exponential:MEAN      exponential with the given mean
+//  bimodal:A:B:P         A with probability P, otherwise B
+//  generational:Y:O:P    exponential with mean Y with probability P (young
+//                        objects), otherwise exponential with mean O
+class distribution
+{
+public:
+    explicit distribution(const std::string & spec)
+    {
+        std::vector<std::string> parts;
+        std::stringstream stream(spec);
+        for(std::string part; std::getline(stream, part, ':'); )
+            parts.push_back(part);
+        if(parts.empty())
+            throw std::invalid_argument("empty distribution");
+
+        const auto & name = parts.front();
+        const std::size_t args = parts.size() - 1;
+        for(std::size_t i = 0; i < args && i < args_.size(); i++)
+            args_[i] = std::stod(parts[i + 1]);
+
+        if("fixed" == name && 1 == args)
+            kind_ = kind::FIXED;
+        else if("uniform" == name && 2 == args && args_[0] <= args_[1])
+            kind_ = kind::UNIFORM;
+        else if("exponential" == name && 1 == args && args_[0] > 0)
+            kind_ = kind::EXPONENTIAL;
+        else if("bimodal" == name && 3 == args)
+            kind_ = kind::BIMODAL;
+        else if("generational" == name && 3 == args && args_[0] > 0 && args_[1] > 0)
+            kind_ = kind::GENERATIONAL;
+        else
+            throw std::invalid_argument("bad distribution: " + spec);
+    }
+
+    template<typename Engine>
+    std::size_t operator()(Engine & engine) const
+    {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        double value = 0;
+        switch(kind_)
+        {
+        case kind::FIXED:
+            value = args_[0];
+            break;
+        case kind::UNIFORM:
+            value = std::uniform_real_distribution<double>(args_[0], args_[1] + 1)(engine);
+            break;
+        case kind::EXPONENTIAL:
+            value = std::exponential_distribution<double>(1.0 / args_[0])(engine);
+            break;
+        case kind::BIMODAL:
+            value = unit(engine) < args_[2] ? args_[0] : args_[1];
+            break;
+        case kind::GENERATIONAL:
+            value = std::exponential_distribution<double>(1.0 / (unit(engine) < args_[2] ? args_[0] : args_[1]))(engine);
+            break;
+        }
+        return static_cast<std::size_t>(std::max(value, 0.0));
+    }
+
+private:
+    enum class kind { FIXED, UNIFORM, EXPONENTIAL, BIMODAL, GENERATIONAL };
+    kind kind_ = kind::FIXED;
+    std::array<double, 3> args_{};
+};
+
+struct options
+{
+    std::vector<std::string> strategies{"none", "lifo", "fifo"};
+    std::vector<std::string> containers{"list", "map"};
+    std::size_t ticks = 2000;
+    double duration_seconds = 0;
+    std::size_t sample = 100;
+    std::size_t arrivals = 4;
+    double churn = 0.05;
+    double shrink = 0;
+    distribution size{"exponential:200"};
+    distribution lifetime{"generational:20:2000:0.9"};
+    unsigned long seed = 1;
+    std::string out;
+};
+
+void usage(std::ostream & stream)
+{
+    stream << "usage: allocator_churn [options]\n"
+              "  --strategy none|lifo|fifo|all     memory_strategy of chunk_allocator (all)\n"
+              "  --container list|map|all          container under test (all)\n"
+              "  --ticks N                         number of simulation ticks (2000)\n"
+              "  --duration-seconds S              stop a run after S seconds (no limit)\n"
+              "  --sample N                        ticks between samples (100)\n"
+              "  --arrivals N                      containers created every tick (4)\n"
+              "  --churn F                         share of elements replaced every tick (0.05)\n"
+              "  --shrink F                        share of elements erased without replacement every tick (0)\n"
+              "  --size-dist SPEC                  elements per container (exponential:200)\n"
+              "  --lifetime-dist SPEC              container lifetime in ticks (generational:20:2000:0.9)\n"
+              "  --seed N                          random seed (1)\n"
+              "  --out FILE                        CSV output, standard output by default\n"
+              "SPEC is fixed:N, uniform:A:B, exponential:MEAN, bimodal:A:B:P or generational:YOUNG:OLD:P\n";
+}
+
+std::vector<std::string> expand(const std::string & value, std::vector<std::string> all)
+{
+    if("all" == value)
+        return all;
+    if(std::find(all.begin(), all.end(), value) == all.end())
+        throw std::invalid_argument("unknown value: " + value);
+    return {value};
+}
+
+options parse(int argc, char * argv[])
+{
+    options result;
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string name = argv[i];
+        if("--help" == name)
+        {
+            usage(std::cout);
+            std::exit(0);
+        }
+        if(i + 1 >= argc)
+            throw std::invalid_argument("missing value for " + name);
+        const std::string value = argv[++i];
+
+        if("--strategy" == name)
+            result.strategies = expand(value, {"none", "lifo", "fifo"});
+        else if("--container" == name)
+            result.containers = expand(value, {"list", "map"});
+        else if("--ticks" == name)
+            result.ticks = std::stoul(value);
+        else if("--duration-seconds" == name)
+            result.duration_seconds = std::stod(value);
+        else if("--sample" == name)
+            result.sample = std::max<std::size_t>(1, std::stoul(value));
+        else if("--arrivals" == name)
+            result.arrivals = std::stoul(value);
+        else if("--churn" == name)
+            result.churn = std::min(1.0, std::max(0.0, std::stod(value)));
+        else if("--shrink" == name)
+            result.shrink = std::min(1.0, std::max(0.0, std::stod(value)));
+        else if("--size-dist" == name)
+            result.size = distribution(value);
+        else if("--lifetime-dist" == name)
+            result.lifetime = distribution(value);
+        else if("--seed" == name)
+            result.seed = std::stoul(value);
+        else if("--out" == name)
+            result.out = value;
+        else
+            throw std::invalid_argument("unknown option: " + name);
+    }
+    return result;
+}
+
+//Resident set size from /proc, zero where it is not available
+std::size_t rss_bytes()
+{
+    std::size_t pages = 0, resident = 0;
+    if(auto * file = std::fopen("/proc/self/statm", "r"))
+    {
+        if(2 != std::fscanf(file, "%zu %zu", &pages, &resident))
+            resident = 0;
+        std::fclose(file);
+    }
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+//Element count changes a little every tick, this rounds the expected count
+//up or down at random so that small containers are churned as well
+template<typename Engine>
+std::size_t share(std::size_t size, double part, Engine & engine)
+{
+    const double expected = size * part;
+    const auto whole = static_cast<std::size_t>(expected);
+    return whole + (std::uniform_real_distribution<double>(0.0, 1.0)(engine) < expected - whole ? 1 : 0);
+}
+
+//Maps lose random elements and get new keys at the end, so old chunks keep
+//a few survivors while new chunks are added. With --shrink more elements are
+//erased than inserted and the maps thin out
+template<allocator::memory_strategy Strategy>
+struct map_model
+{
+    using container = app::int_map<int, allocator::chunk_allocator<std::pair<const int, int>, 10, Strategy>>;
+    struct item
+    {
+        container values;
+        int next_key = 0;
+    };
+
+    static const char * name() { return "map"; }
+
+    template<typename Engine>
+    static std::unique_ptr<item> make(std::size_t size, Engine &)
+    {
+        auto result = std::make_unique<item>();
+        for( ; static_cast<std::size_t>(result->next_key) < size; result->next_key++)
+            result->values.emplace_hint(result->values.end(), result->next_key, result->next_key);
+        return result;
+    }
+
+    template<typename Engine>
+    static void churn(item & value, const options & config, Engine & engine)
+    {
+        if(value.values.empty())
+            return;
+        const auto count = share(value.values.size(), config.churn, engine);
+        const auto erased = count + share(value.values.size(), config.shrink, engine);
+        std::uniform_int_distribution<int> keys(value.values.begin()->first, value.next_key - 1);
+        for(std::size_t i = 0; i < erased && !value.values.empty(); i++)
+        {
+            auto it = value.values.lower_bound(keys(engine));
+            value.values.erase(it == value.values.end() ? value.values.begin() : it);
+        }
+        for(std::size_t i = 0; i < count; i++, value.next_key++)
+            value.values.emplace_hint(value.values.end(), value.next_key, value.next_key);
+    }
+
+    static std::size_t size(const item & value) { return value.values.size(); }
+};
+
+//Lists lose random elements and get new ones at the front. Like with maps,
+//old chunks keep a few survivors and --shrink thins the lists out
+template<allocator::memory_strategy Strategy>
+struct list_model
+{
+    using container = app::int_list<int, allocator::chunk_allocator<int, 10, Strategy>>;
+    struct item
+    {
+        container values;
+        std::size_t size = 0;
+        int next_value = 0;
+    };
+
+    static const char * name() { return "list"; }
+
+    template<typename Engine>
+    static std::unique_ptr<item> make(std::size_t size, Engine &)
+    {
+        auto result = std::make_unique<item>();
+        insert(*result, size);
+        return result;
+    }
+
+    template<typename Engine>
+    static void churn(item & value, const options & config, Engine & engine)
+    {
+        if(0 == value.size)
+            return;
+        const auto count = share(value.size, config.churn, engine);
+        const auto part = std::min(1.0, config.churn + config.shrink);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        value.size -= value.values.remove_if([&](int) { return unit(engine) < part; });
+        insert(value, count);
+    }
+
+    static std::size_t size(const item & value) { return value.size; }
+
+private:
+    static void insert(item & value, std::size_t count)
+    {
+        value.values.generate_front(count, [&value]() { return value.next_value++; });
+        value.size += count;
+    }
+};
+
+const char * strategy_name(allocator::memory_strategy strategy)
+{
+    switch(strategy)
+    {
+    case allocator::memory_strategy::NONE: return "none";
+    case allocator::memory_strategy::LIFO: return "lifo";
+    case allocator::memory_strategy::FIFO: return "fifo";
+    }
+    return "";
+}
+
+template<typename Model, allocator::memory_strategy Strategy>
+void simulate(const options & config, std::ostream & out)
+{
+    using clock = std::chrono::steady_clock;
+    struct live
+    {
+        std::unique_ptr<typename Model::item> value;
+        std::size_t expires;
+    };
+
+    std::mt19937_64 engine(config.seed);
+    std::vector<live> items;
+    const auto start = clock::now();
+
+    for(std::size_t tick = 0; tick <= config.ticks; tick++)
+    {
+        const auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        const bool last = tick == config.ticks || (config.duration_seconds > 0 && elapsed >= config.duration_seconds);
+
+        items.erase(std::remove_if(items.begin(), items.end(),
+                                   [tick](const live & value) { return value.expires <= tick; }),
+                    items.end());
+        for(auto & value : items)
+            Model::churn(*value.value, config, engine);
+        for(std::size_t i = 0; i < config.arrivals; i++)
+        {
+            auto value = Model::make(config.size(engine), engine);
+            items.push_back({std::move(value), tick + 1 + config.lifetime(engine)});
+        }
+
+        if(0 == tick % config.sample || last)
+        {
+            std::size_t elements = 0;
+            for(const auto & value : items)
+                elements += Model::size(*value.value);
+            const auto stats = allocator::statistics();
+            out << tick << ',' << static_cast<long long>(elapsed * 1000) << ','
+                << Model::name() << ',' << strategy_name(Strategy) << ','
+                << items.size() << ',' << elements << ','
+                << stats.live_bytes << ',' << stats.reserved_bytes << ','
+                << stats.chunks << ',' << rss_bytes() << '\n';
+        }
+        if(last)
+            break;
+    }
+    out.flush();
+}
+
+template<template<allocator::memory_strategy> class Model>
+void simulate(const options & config, const std::string & strategy, std::ostream & out)
+{
+    if("none" == strategy)
+        simulate<Model<allocator::memory_strategy::NONE>, allocator::memory_strategy::NONE>(config, out);
+    else if("lifo" == strategy)
+        simulate<Model<allocator::memory_strategy::LIFO>, allocator::memory_strategy::LIFO>(config, out);
+    else
+        simulate<Model<allocator::memory_strategy::FIFO>, allocator::memory_strategy::FIFO>(config, out);
+}
+
+//Runs the simulation in a child process that starts with the memory of the
+//parent before any simulation. The child writes its rows to the inherited
+//stream and the parent waits for it, so the rows stay in order
+template<typename Run>
+void run_isolated(std::ostream & out, Run run)
+{
+    out.flush();
+    const auto child = fork();
+    if(child < 0)
+        throw std::runtime_error("fork failed");
+    if(0 == child)
+    {
+        auto code = 0;
+        try {
+            run(out);
+        } catch (const std::exception & e) {
+            std::cerr << e.what() << std::endl;
+            code = 1;
+        }
+        out.flush();
+        _exit(code);
+    }
+
+    auto status = 0;
+    if(child != waitpid(child, &status, 0) || !WIFEXITED(status) || 0 != WEXITSTATUS(status))
+        throw std::runtime_error("simulation process failed");
+}
+
+} //namespace
+
+int main(int argc, char * argv[])
+{
+    try
+    {
+        const auto config = parse(argc, argv);
+
+        std::ofstream file;
+        if(!config.out.empty())
+        {
+            file.open(config.out);
+            if(!file)
+                throw std::runtime_error("can not open " + config.out);
+        }
+        auto & out = config.out.empty() ? std::cout : file;
+
+        out << "tick,elapsed_ms,container,strategy,live_containers,live_elements,"
+               "live_bytes,reserved_bytes,chunks,rss_bytes\n";
+        for(const auto & container : config.containers)
+            for(const auto & strategy : config.strategies)
+                run_isolated(out, [&config, &container, &strategy](std::ostream & stream) {
+                    if("list" == container)
+                        simulate<list_model>(config, strategy, stream);
+                    else
+                        simulate<map_model>(config, strategy, stream);
+                });
+    }
+    catch(const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        usage(std::cerr);
+        return 1;
+    }
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace allocator {
+
+
+//Multi-producer ingest list. Any number of threads may push_front at the
+//same time, a single consumer detaches everything pushed so far with
+//take_all. Nodes are allocated from allocator shards, every thread uses its
+//own shard. Shards = 0 (Default) creates one shard per hardware thread, so
+//producers share a shard lock only when there are more producer threads than
+//hardware threads. The lock of an unshared shard is never contended.
+//
+//The consumer does not take shard locks. Released nodes are pushed to a
+//lock-free return stack of their shard and are given back to the allocator
+//by the next push of that shard or by the destructor.
+//
+//The head is updated with a compare-and-swap loop (Treiber stack). Nodes are
+//never removed one by one, the consumer swaps the whole chain out. So a push
+//that sees the same head address again after the node was released and
+//reused still links to the current head and the ABA case is harmless. The
+//return stacks are only pushed to and emptied as a whole for the same reason
+template <typename T, typename Alloc = std::allocator<T>, std::size_t Shards = 0>
+class concurrent_list
+{
+
+    struct node
+    {
+        node() {}
+        T value;
+        node * next = nullptr;
+        std::size_t shard = 0;
+    };
+
+    using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+    using node_traits = std::allocator_traits<allocator_type>;
+
+    //Padded to a cache line, so threads working with their own shards do not
+    //invalidate each other
+    struct shard
+    {
+        std::mutex          mutex;
+        allocator_type      alloc{};
+        //Nodes released by the consumer and not yet deallocated
+        std::atomic<node*>  returned{nullptr};
+        char                padding[64];
+    };
+
+public:
+    using value_type = T;
+    using reference = T&;
+    using size_type = std::size_t;
+
+    //Chain of nodes detached by take_all, the newest element comes first.
+    //The batch has to be released before the list it was taken from
+    class batch
+    {
+        friend class concurrent_list;
+    public:
+        class iterator
+        {
+            friend class batch;
+        public:
+            using value_type = T;
+            using reference = T&;
+            using pointer = T*;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::forward_iterator_tag;
+
+            bool operator==(const iterator &value) const { return node_ == value.node_; }
+            bool operator!=(const iterator &value) const { return !operator==(value); }
+            iterator& operator++() {
+                if(nullptr == node_)
+                    throw std::range_error("operator ++ out of range");
+                node_ = node_->next;
+                return *this;
+            }
+            reference operator*() { return node_->value; }
+        private:
+            explicit iterator(node * ptr) : node_(ptr) {}
+            node * node_;
+        };
+
+        batch(batch&& value) : owner_(value.owner_), head_(value.head_)
+        {
+            value.head_ = nullptr;
+        }
+        batch& operator=(batch&& value)
+        {
+            if(this != &value)
+            {
+                clear();
+                owner_ = value.owner_;
+                std::swap(head_, value.head_);
+            }
+            return *this;
+        }
+        batch(const batch&) = delete;
+        batch& operator=(const batch&) = delete;
+        ~batch()
+        {
+            clear();
+        }
+
+        //Puts the elements in the order they were pushed
+        void reverse()
+        {
+            node * result = nullptr;
+            while(nullptr != head_)
+            {
+                auto * next = head_->next;
+                head_->next = result;
+                result = head_;
+                head_ = next;
+            }
+            head_ = result;
+        }
+
+        void clear()
+        {
+            owner_->release(head_);
+            head_ = nullptr;
+        }
+
+        iterator begin() { return iterator(head_); }
+        iterator end() { return iterator(nullptr); }
+        bool empty() const { return nullptr == head_; }
+
+    private:
+        batch(concurrent_list * owner, node * head) : owner_(owner), head_(head) {}
+        concurrent_list * owner_;
+        node * head_;
+    };
+
+    concurrent_list() :
+        shard_count_(0 != Shards ? Shards : std::max(1u, std::thread::hardware_concurrency())),
+        shards_(new shard[shard_count_])
+    {}
+    concurrent_list(const concurrent_list&) = delete;
+    concurrent_list& operator=(const concurrent_list&) = delete;
+    ~concurrent_list()
+    {
+        release(head_.exchange(nullptr, std::memory_order_acquire));
+        for(std::size_t i = 0; i < shard_count_; i++)
+            reclaim(shards_[i]);
+    }
+
+    void push_front(const T& value)
+    {
+        emplace_front(value);
+    }
+    void push_front(T&& value)
+    {
+        emplace_front(std::move(value));
+    }
+
+    template<typename... Args>
+    void emplace_front(Args&&... args)
+    {
+        auto * ptr = make_node(std::forward<Args>(args)...);
+        ptr->next = head_.load(std::memory_order_relaxed);
+        while(!head_.compare_exchange_weak(ptr->next, ptr, std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+
+    //Detaches all elements pushed so far. Only one thread may consume them
+    batch take_all()
+    {
+        return batch(this, head_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    bool empty() const { return nullptr == head_.load(std::memory_order_relaxed); }
+
+    std::size_t shard_count() const { return shard_count_; }
+
+private:
+    std::size_t thread_shard() const
+    {
+        static std::atomic<std::size_t> next_thread{0};
+        thread_local const std::size_t index = next_thread.fetch_add(1, std::memory_order_relaxed);
+        return index % shard_count_;
+    }
+
+    //Gives the nodes returned by the consumer back to the allocator. Called
+    //under the shard lock or when no other thread uses the list
+    void reclaim(shard & owner)
+    {
+        auto * ptr = owner.returned.exchange(nullptr, std::memory_order_acquire);
+        while(nullptr != ptr)
+        {
+            auto * next = ptr->next;
+            node_traits::deallocate(owner.alloc, ptr, 1);
+            ptr = next;
+        }
+    }
+
+    template<typename... Args>
+    node * make_node(Args&&... args)
+    {
+        const auto index = thread_shard();
+        auto & owner = shards_[index];
+        node * ptr = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(owner.mutex);
+            reclaim(owner);
+            ptr = node_traits::allocate(owner.alloc, 1);
+        }
+        try {
+            node_traits::construct(owner.alloc, &(ptr->value), std::forward<Args>(args)...);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(owner.mutex);
+            node_traits::deallocate(owner.alloc, ptr, 1);
+            throw;
+        }
+        ptr->next = nullptr;
+        ptr->shard = index;
+        return ptr;
+    }
+
+    //Destroys the values and pushes the nodes to the return stacks of their
+    //shards. Nodes pushed by one thread are usually next to each other, so
+    //a run of nodes of the same shard is pushed with one compare-and-swap
+    void release(node * ptr)
+    {
+        while(nullptr != ptr)
+        {
+            auto & owner = shards_[ptr->shard];
+            auto * first = ptr;
+            auto * last = ptr;
+            node_traits::destroy(owner.alloc, &(ptr->value));
+            ptr = ptr->next;
+            while(nullptr != ptr && ptr->shard == first->shard)
+            {
+                node_traits::destroy(owner.alloc, &(ptr->value));
+                last = ptr;
+                ptr = ptr->next;
+            }
+            last->next = owner.returned.load(std::memory_order_relaxed);
+            while(!owner.returned.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed))
+                ;
+        }
+    }
+
+    const std::size_t           shard_count_;
+    std::unique_ptr<shard[]>    shards_;
+    std::atomic<node*>          head_{nullptr};
+};
+
+} //namespace allocator
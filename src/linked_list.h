@@ -2,6 +2,9 @@
 
 #include <memory>
 #include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
 
 namespace allocator {
 
@@ -74,6 +77,7 @@ private:
     allocator_type      alloc_{};
     unique_ptr          head_{ nullptr, &alloc_};
     unique_ptr          tail_{ nullptr};
+    node *              back_ = nullptr;
 
 private:
     struct deleter
@@ -92,19 +96,104 @@ private:
 
         }
     };
+    //Links between nodes do not own memory. Nodes are released by the list
+    //one by one, so long lists are not destroyed recursively
     template<typename... Args>
     auto make_node(Args&&... args)
     {
         unique_ptr ptr {node_traits::allocate(alloc_, 1), deleter(&alloc_)};
         node_traits::construct(alloc_, &(ptr->value), std::forward<Args>(args)...);
-        node_traits::construct(alloc_, &(ptr->next), nullptr, &alloc_);
+        node_traits::construct(alloc_, &(ptr->next), nullptr);
         return ptr;
     }
 
+    //Allocators that can drop all their memory at once release the nodes
+    //without visiting each one, only values that need it are destroyed
+    template<typename A>
+    auto release_nodes(A& alloc, int) -> decltype(alloc.release_all(), void())
+    {
+        if(!std::is_trivially_destructible<T>::value)
+            for(auto * ptr = head_.get(); nullptr != ptr; ptr = ptr->next.get())
+                node_traits::destroy(alloc, &(ptr->value));
+        head_.release();
+        alloc.release_all();
+    }
+    template<typename A>
+    void release_nodes(A&, long)
+    {
+        destroy(head_);
+    }
+
+    void destroy(unique_ptr& chain)
+    {
+        while(nullptr != chain)
+        {
+            auto * next = chain->next.release();
+            chain.reset(next);
+        }
+    }
+
+    //Builds a chain in the order values are produced and puts it in front
+    template<typename Fill>
+    void prepend(Fill fill)
+    {
+        unique_ptr chain{ nullptr, &alloc_};
+        auto * last = &chain;
+        node * back = nullptr;
+        try {
+            fill([this, &last, &back](auto&& value) {
+                last->reset(make_node(std::forward<decltype(value)>(value)).release());
+                back = last->get();
+                last = &back->next;
+            });
+        } catch (...) {
+            destroy(chain);
+            throw;
+        }
+        if(nullptr == chain)
+            return;
+        if(empty())
+            back_ = back;
+        last->reset(head_.release());
+        head_.reset(chain.release());
+    }
+
+    //Memory of the spliced nodes has to be released by this list allocator
+    template<typename A>
+    static auto adopt_memory(A& alloc, A& other, int) -> decltype(alloc.merge(other), void())
+    {
+        alloc.merge(other);
+    }
+    template<typename A>
+    static void adopt_memory(A& alloc, A& other, long)
+    {
+        if(!(alloc == other))
+            throw std::invalid_argument("Lists with different allocators cannot be spliced");
+    }
+
+    //Allocators that can grow in batches get the whole request at once
+    template<typename A>
+    static auto reserve_nodes(A& alloc, size_type n, int) -> decltype(alloc.reserve(n), void())
+    {
+        alloc.reserve(n);
+    }
+    template<typename A>
+    static void reserve_nodes(A&, size_type, long) {}
+
+    template<typename InputIt>
+    void reserve_range(InputIt, InputIt, std::input_iterator_tag) {}
+    template<typename ForwardIt>
+    void reserve_range(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+    {
+        reserve_nodes(alloc_, static_cast<size_type>(std::distance(first, last)), 0);
+    }
+
     void insert_front( unique_ptr& ptr)
     {
         if(!empty())
             ptr->next.reset(head_.release());
+        else
+            back_ = ptr.get();
 
         head_.reset(ptr.release());
       }
@@ -112,6 +201,22 @@ private:
 
 public:
     linked_list()= default;
+    //Only iterators are accepted, so linked_list<int>(3, 4) does not compile
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    linked_list(InputIt first, InputIt last)
+    {
+        push_front(first, last);
+    }
+    ~linked_list()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        release_nodes(alloc_, 0);
+        back_ = nullptr;
+    }
 
     void push_front( const T& value )
     {
@@ -126,6 +231,69 @@ public:
         insert_front(ptr);
     }
 
+    //Puts the range in front of the list keeping the order of the range
+    template<typename InputIt>
+    void push_front(InputIt first, InputIt last)
+    {
+        reserve_range(first, last, typename std::iterator_traits<InputIt>::iterator_category{});
+        prepend([&first, &last](auto&& emit) {
+            for( ; first != last; ++first)
+                emit(*first);
+        });
+    }
+
+    //Puts n values returned by gen in front of the list in the order of generation
+    template<typename Generator>
+    void generate_front(size_type n, Generator gen)
+    {
+        reserve_nodes(alloc_, n, 0);
+        prepend([n, &gen](auto&& emit) {
+            for(size_type i = 0; i < n; i++)
+                emit(gen());
+        });
+    }
+
+    //Moves all elements of the other list in front of this list in
+    //constant time, the other list gets empty
+    void splice_front(linked_list& other)
+    {
+        if(this == &other || other.empty())
+            return;
+        adopt_memory(alloc_, other.alloc_, 0);
+        if(empty())
+            back_ = other.back_;
+        else
+            other.back_->next.reset(head_.release());
+        head_.reset(other.head_.release());
+        other.back_ = nullptr;
+    }
+
+    //Erases the elements the predicate is true for in one pass and returns
+    //their number
+    template<typename Predicate>
+    size_type remove_if(Predicate pred)
+    {
+        size_type removed = 0;
+        node * back = nullptr;
+        auto * link = &head_;
+        while(nullptr != *link)
+        {
+            auto * ptr = link->get();
+            if(!pred(ptr->value))
+            {
+                back = ptr;
+                link = &ptr->next;
+                continue;
+            }
+            unique_ptr erased{ptr, deleter(&alloc_)};
+            link->release();
+            link->reset(erased->next.release());
+            removed++;
+        }
+        back_ = back;
+        return removed;
+    }
+
     reference front() { return head_->value;}
 
     iterator begin() { return iterator(&head_);}
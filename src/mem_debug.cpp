@@ -2,28 +2,89 @@
 #include <stdio.h>
 #include <new>
 
+#include "mem_debug.h"
+
 namespace app {
 
+  //The counter is updated atomically, so allocations made by worker threads
+  //are counted as well. It is read only after the threads are joined
   std::size_t alloc_counter = 0;
 
   void* malloc(std::size_t size)
   {
     void* p = std::malloc(size);
-    ++alloc_counter;
+    const auto counter = __atomic_add_fetch(&alloc_counter, 1, __ATOMIC_RELAXED);
 #ifdef APP_DEBUG_PRINT
-    printf("malloc: %zu %p %zu\n", alloc_counter, p, size);
+    printf("malloc: %zu %p %zu\n", counter, p, size);
+#else
+    (void)counter;
 #endif
     return p;
   }
 
   void free(void* p) noexcept
   {
-      --alloc_counter;
+    const auto counter = __atomic_sub_fetch(&alloc_counter, 1, __ATOMIC_RELAXED);
 #ifdef APP_DEBUG_PRINT
-    printf("free: %zu %p\n", alloc_counter, p);
+    printf("free: %zu %p\n", counter, p);
+#else
+    (void)counter;
 #endif
     std::free(p);
     return;
   }
 } //namespace app
 
+//Replacement of the global allocation functions. They have to be defined
+//once and not inline, otherwise memory allocated inside the standard library
+//is released through a different function and the counter drifts
+
+void* operator new(std::size_t size)
+{
+    return app::malloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    app::free(p);
+}
+
+void* operator new[](std::size_t size)
+{
+    return app::malloc(size);
+}
+
+void operator delete[](void* p)
+{
+    app::free(p);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+        return app::malloc(size);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    app::free(p);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+        return app::malloc(size);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    app::free(p);
+}
+
+void operator delete(void* p, long unsigned int)
+{
+    app::free(p);
+}
+
+void operator delete [](void* p, long unsigned int)
+{
+    app::free(p);
+}
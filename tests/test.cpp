@@ -1,10 +1,19 @@
 #include <linked_list.h>
 #include <chunk_allocator.h>
+#include <concurrent_list.h>
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <app_lib.h>
+#include <app_parallel.h>
+#include <app_serialization.h>
 
 
 using namespace testing;
@@ -282,6 +291,909 @@ TEST(app_lib_case, map_int_custom_allocator_test)
 }
 
 
+TEST(bulk_load_case, list_range_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using namespace allocator;
+        const std::vector<int> values{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        linked_list<int, chunk_allocator<int, 2>> list(values.begin(), values.end());
+        list.push_front(values.begin(), values.begin() + 3);
+
+        std::ostringstream log;
+        for (const auto &value : list) {
+            log << value << ',';
+        }
+
+        ASSERT_EQ(log.str(), "0,1,2,0,1,2,3,4,5,6,7,8,9,");
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+TEST(bulk_load_case, remove_if_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using namespace allocator;
+        using list_t = linked_list<int, chunk_allocator<int, 2, memory_strategy::LIFO>>;
+        list_t list;
+        app::fill_cntr(list, 100);
+
+        ASSERT_EQ(50u, list.remove_if([](int value) { return 1 == value % 2; }));
+        ASSERT_EQ(1u, list.remove_if([](int value) { return 98 == value; }));
+
+        //The last element is tracked after the removal, splicing links behind it
+        list_t other;
+        app::fill_cntr(other, 2);
+        other.splice_front(list);
+
+        std::ostringstream log;
+        for (const auto &value : other)
+            log << value << ',';
+        ASSERT_EQ(log.str(), "0,2,4,6,8,10,12,14,16,18,20,22,24,26,28,30,32,34,36,38,40,42,44,46,48,"
+                             "50,52,54,56,58,60,62,64,66,68,70,72,74,76,78,80,82,84,86,88,90,92,94,96,0,1,");
+
+        ASSERT_EQ(51u, other.remove_if([](int) { return true; }));
+        ASSERT_TRUE(other.empty());
+        other.push_front(7);
+        ASSERT_EQ(7, other.front());
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+TEST(bulk_load_case, range_constructor_test)
+{
+    static_assert(std::is_constructible<allocator::linked_list<int>, const int*, const int*>::value,
+                  "Iterator range constructor");
+    static_assert(!std::is_constructible<allocator::linked_list<int>, int, int>::value,
+                  "Integers are not an iterator range");
+}
+
+TEST(bulk_load_case, map_factorial_test)
+{
+    app::int_map<long long> map;
+    app::fill_cntr(map, 21);
+    ASSERT_EQ(map.size(), 21u);
+    for (const auto & p : map)
+        ASSERT_EQ(app::factorial(p.first), p.second);
+}
+
+TEST(bulk_load_case, large_list_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using custom_link_custom_alloc = app::int_list<int, allocator::chunk_allocator<int>>;
+        custom_link_custom_alloc list;
+        app::fill_cntr(list, 1000000);
+
+        auto expected = 0;
+        for (const auto &value : list)
+            ASSERT_EQ(expected++, value);
+        ASSERT_EQ(expected, 1000000);
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+TEST(bulk_load_case, small_batches_test)
+{
+    using namespace allocator;
+    using alloc_t = chunk_allocator<int>;
+    const auto before = statistics();
+    {
+        linked_list<int, alloc_t> list;
+        app::fill_cntr(list, 1000000);
+
+        //Small batches only look at the chunks with free cells, a large
+        //list does not make them slower
+        const std::vector<int> values{1, 2};
+        for(auto i = 0; i < 20000; i++)
+            list.push_front(values.begin(), values.end());
+        list.generate_front(2, []() { return 3; });
+
+        const size_t expected_chunks = (1000000 + 40002 + alloc_t::chunk_capacity() - 1) / alloc_t::chunk_capacity();
+        ASSERT_EQ(before.chunks + expected_chunks, statistics().chunks);
+
+        auto it = list.begin();
+        ASSERT_EQ(3, *it);
+        ++it;
+        ASSERT_EQ(3, *it);
+        ++it;
+        ASSERT_EQ(1, *it);
+        ++it;
+        ASSERT_EQ(2, *it);
+    }
+    ASSERT_EQ(before.chunks, statistics().chunks);
+}
+
+TEST(bulk_load_case, map_sorted_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using map_custom_alloc = app::int_map<int, allocator::chunk_allocator<std::pair<const int, int>>>;
+        map_custom_alloc map;
+        const std::vector<std::pair<int, int>> values{{1, 10}, {2, 20}, {5, 50}};
+        app::load_sorted(map, values.begin(), values.end());
+        app::generate_sorted(map, 3, [i = 6]() mutable { auto value = std::make_pair(i, i * 10); ++i; return value; });
+
+        std::ostringstream log;
+        app::operator<<(log, map);
+        ASSERT_EQ(log.str(), "1 10\n2 20\n5 50\n6 60\n7 70\n8 80\n");
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+
+TEST(serialization_case, text_test)
+{
+    std::string out;
+    {
+        app::int_map<> map;
+        app::fill_cntr(map);
+        app::int_list<long> list;
+        app::fill_cntr(list, 3);
+        list.push_front(std::numeric_limits<long>::min());
+
+        auto writer = app::make_writer(app::memory_sink(out), 64);
+        app::write_text(writer, map);
+        app::write_text(writer, list);
+        writer.flush();
+    }
+
+    ASSERT_EQ(out,
+              "0 1\n"
+              "1 1\n"
+              "2 2\n"
+              "3 6\n"
+              "4 24\n"
+              "5 120\n"
+              "6 720\n"
+              "7 5040\n"
+              "8 40320\n"
+              "9 362880\n"
+              + std::to_string(std::numeric_limits<long>::min()) + "\n"
+              "0\n"
+              "1\n"
+              "2\n");
+}
+
+TEST(serialization_case, binary_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using map_custom_alloc = app::int_map<int, allocator::chunk_allocator<std::pair<const int, int>>>;
+        using custom_link_custom_alloc = app::int_list<int, allocator::chunk_allocator<int>>;
+
+        std::string out;
+        {
+            map_custom_alloc map;
+            app::generate_sorted(map, 1000, [i = 0]() mutable { auto value = std::make_pair(i, -i); ++i; return value; });
+            custom_link_custom_alloc list;
+            app::fill_cntr(list, 1000);
+
+            auto writer = app::make_writer(app::memory_sink(out), 100);
+            app::write_binary(writer, map);
+            app::write_binary(writer, list);
+            writer.flush();
+        }
+
+        map_custom_alloc map;
+        custom_link_custom_alloc list;
+        auto reader = app::make_reader(app::memory_source(out), 100);
+        app::read_binary(reader, map);
+        app::read_binary(reader, list);
+
+        ASSERT_EQ(map.size(), 1000u);
+        auto i = 0;
+        for (const auto & p : map)
+        {
+            ASSERT_EQ(i, p.first);
+            ASSERT_EQ(-i, p.second);
+            ++i;
+        }
+        i = 0;
+        for (const auto & value : list)
+            ASSERT_EQ(i++, value);
+        ASSERT_EQ(i, 1000);
+
+        auto wrong_kind = app::make_reader(app::memory_source(out));
+        ASSERT_THROW(app::read_binary(wrong_kind, list), std::runtime_error);
+        auto truncated = app::make_reader(app::memory_source(out.data(), 20));
+        map_custom_alloc partial;
+        ASSERT_THROW(app::read_binary(truncated, partial), std::runtime_error);
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+TEST(serialization_case, corrupt_count_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using custom_link_custom_alloc = app::int_list<int, allocator::chunk_allocator<int>>;
+        std::string out;
+        {
+            custom_link_custom_alloc list;
+            app::fill_cntr(list, 2);
+            auto writer = app::make_writer(app::memory_sink(out));
+            app::write_binary(writer, list);
+            writer.flush();
+        }
+
+        //The header claims INT_MAX values, but only two follow
+        const std::uint64_t count = std::numeric_limits<int>::max();
+        std::memcpy(&out[out.size() - 2 * sizeof(int) - sizeof(count)], &count, sizeof(count));
+
+        custom_link_custom_alloc list;
+        auto reader = app::make_reader(app::memory_source(out));
+        try {
+            app::read_binary(reader, list);
+            FAIL() << "Corrupt count is not detected";
+        } catch (const std::runtime_error & error) {
+            ASSERT_STREQ("Unexpected end of data", error.what());
+        }
+        ASSERT_TRUE(list.empty());
+    }
+    ASSERT_EQ(counter, app::alloc_counter);
+}
+
+TEST(serialization_case, truncated_map_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using map_custom_alloc = app::int_map<int, allocator::chunk_allocator<std::pair<const int, int>>>;
+        std::string out;
+        {
+            app::int_map<> map;
+            app::generate_sorted(map, 100, [i = 10]() mutable { auto value = std::make_pair(i, i); ++i; return value; });
+            auto writer = app::make_writer(app::memory_sink(out));
+            app::write_binary(writer, map);
+            writer.flush();
+        }
+        const std::string truncated = out.substr(0, out.size() - sizeof(int));
+
+        //Both the swapped and the copied load leave the map unchanged
+        app::int_map<> empty;
+        auto reader = app::make_reader(app::memory_source(truncated));
+        ASSERT_THROW(app::read_binary(reader, empty), std::runtime_error);
+        ASSERT_TRUE(empty.empty());
+
+        map_custom_alloc map;
+        map.emplace(1, 1);
+        reader = app::make_reader(app::memory_source(truncated));
+        ASSERT_THROW(app::read_binary(reader, map), std::runtime_error);
+        ASSERT_EQ(1u, map.size());
+
+        reader = app::make_reader(app::memory_source(out));
+        app::read_binary(reader, map);
+        ASSERT_EQ(101u, map.size());
+        ASSERT_EQ(109, map.rbegin()->first);
+
+        reader = app::make_reader(app::memory_source(out));
+        app::read_binary(reader, empty);
+        ASSERT_EQ(100u, empty.size());
+    }
+    ASSERT_EQ(counter, app::alloc_counter);
+}
+
+TEST(serialization_case, large_list_test)
+{
+    using custom_link_custom_alloc = app::int_list<int, allocator::chunk_allocator<int>>;
+    const int size = 200000;
+    std::string out;
+    {
+        custom_link_custom_alloc list;
+        app::fill_cntr(list, size);
+        auto writer = app::make_writer(app::memory_sink(out));
+        app::write_binary(writer, list);
+        writer.flush();
+    }
+
+    custom_link_custom_alloc list;
+    list.push_front(-1);
+    auto reader = app::make_reader(app::memory_source(out));
+    app::read_binary(reader, list);
+
+    auto i = 0;
+    for (const auto & value : list)
+    {
+        if(size == i)
+        {
+            ASSERT_EQ(-1, value);
+            break;
+        }
+        ASSERT_EQ(i++, value);
+    }
+    ASSERT_EQ(size, i);
+}
+
+TEST(serialization_case, fd_test)
+{
+    FILE * file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+    const auto fd = fileno(file);
+    {
+        app::int_list<> list;
+        app::fill_cntr(list, 5);
+        auto writer = app::make_writer(app::fd_sink(fd));
+        app::write_binary(writer, list);
+        app::write_text(writer, list);
+        writer.flush();
+    }
+    ASSERT_EQ(0, lseek(fd, 0, SEEK_SET));
+
+    app::int_list<> list;
+    auto reader = app::make_reader(app::fd_source(fd));
+    app::read_binary(reader, list);
+    std::string text(10, ' ');
+    reader.read(&text[0], text.size());
+    std::fclose(file);
+
+    std::ostringstream log;
+    app::operator<<(log, list);
+    ASSERT_EQ(log.str(), text);
+    ASSERT_EQ(text, "0\n1\n2\n3\n4\n");
+}
+
+
+TEST(serialization_case, write_error_test)
+{
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+
+    //Writing to the read end of the pipe fails, the error is seen on flush
+    app::int_list<> list;
+    app::fill_cntr(list, 5);
+    auto writer = app::make_writer(app::fd_sink(fds[0]));
+    app::write_text(writer, list);
+    ASSERT_THROW(writer.flush(), std::system_error);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+
+TEST(parallel_case, list_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using custom_link_custom_alloc = app::int_list<int, allocator::chunk_allocator<int>>;
+        custom_link_custom_alloc list;
+        list.push_front(-1);
+        app::parallel_fill_cntr(list, 100000, 4);
+        list.push_front(-2);
+
+        auto expected = 0;
+        auto it = list.begin();
+        ASSERT_EQ(-2, *it);
+        for (++it; expected < 100000; ++it)
+            ASSERT_EQ(expected++, *it);
+        ASSERT_EQ(-1, *it);
+        ASSERT_TRUE(++it == list.end());
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+TEST(parallel_case, map_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        std::ostringstream log;
+        using map_custom_alloc = app::int_map<int, allocator::chunk_allocator<std::pair<const int, int>>>;
+        app::parallel_fill_and_print(log, map_custom_alloc{}, 10, 3);
+
+        ASSERT_EQ(log.str(),
+                  "0 1\n"
+                  "1 1\n"
+                  "2 2\n"
+                  "3 6\n"
+                  "4 24\n"
+                  "5 120\n"
+                  "6 720\n"
+                  "7 5040\n"
+                  "8 40320\n"
+                  "9 362880\n"
+                  );
+
+        app::int_map<> map;
+        app::parallel_generate_sorted(map, 1000, [](int i) { return std::make_pair(999 - i, i); }, 5);
+        ASSERT_EQ(map.size(), 1000u);
+        auto expected = 0;
+        for (const auto & p : map)
+        {
+            ASSERT_EQ(expected, p.first);
+            ASSERT_EQ(999 - expected, p.second);
+            ++expected;
+        }
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+
+TEST(concurrent_list_case, producers_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using namespace allocator;
+        constexpr auto producers = 4;
+        constexpr auto items = 20000;
+        concurrent_list<int, chunk_allocator<int>> list;
+
+        std::vector<std::thread> threads;
+        for(auto p = 0; p < producers; p++)
+            threads.emplace_back([&list, p]() {
+                for(auto i = 0; i < items; i++)
+                    list.push_front(p * items + i);
+            });
+
+        std::vector<int> seen(producers * items, 0);
+        std::vector<int> last(producers, -1);
+        auto received = 0;
+        auto consume = [&]() {
+            auto batch = list.take_all();
+            batch.reverse();
+            for(const auto value : batch)
+            {
+                seen[value]++;
+                //Elements of one producer come in the order they were pushed
+                EXPECT_LT(last[value / items], value % items);
+                last[value / items] = value % items;
+                received++;
+            }
+        };
+        while(received < producers * items)
+            consume();
+        for(auto & thread : threads)
+            thread.join();
+        consume();
+
+        ASSERT_TRUE(list.empty());
+        ASSERT_EQ(producers * items, received);
+        ASSERT_TRUE(std::all_of(seen.begin(), seen.end(), [](int count) { return 1 == count; }));
+
+        list.push_front(1);
+        list.push_front(2);
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+TEST(concurrent_list_case, shared_shards_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using namespace allocator;
+        constexpr auto producers = 6;
+        constexpr auto items = 5000;
+        concurrent_list<int, chunk_allocator<int>, 2> list;
+        ASSERT_EQ(2u, list.shard_count());
+
+        //More producers than shards, the consumer releases nodes while the
+        //producers allocate from the same shards
+        std::vector<std::thread> threads;
+        for(auto p = 0; p < producers; p++)
+            threads.emplace_back([&list]() {
+                for(auto i = 0; i < items; i++)
+                    list.push_front(i);
+            });
+
+        long long received = 0, sum = 0;
+        while(received < producers * items)
+            for(const auto value : list.take_all())
+            {
+                sum += value;
+                received++;
+            }
+        for(auto & thread : threads)
+            thread.join();
+
+        ASSERT_EQ(producers * items, received);
+        ASSERT_EQ(static_cast<long long>(producers) * items * (items - 1) / 2, sum);
+
+        concurrent_list<int> automatic;
+        ASSERT_LE(1u, automatic.shard_count());
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+
+TEST(chunk_cache_case, list_test)
+{
+    using namespace allocator;
+    using cached_alloc = chunk_allocator<int, 2, memory_strategy::NONE, recycled_chunk_cache<4, 8>>;
+    using list_t = linked_list<int, cached_alloc>;
+
+    //The first use of the thread local cache makes the runtime allocate a
+    //record for its destructor, it is not counted
+    {
+        list_t list;
+        app::fill_cntr(list, 100);
+    }
+    recycled_chunk_cache<4, 8>::trim();
+
+    const auto counter = app::alloc_counter;
+    {
+        list_t list;
+        app::fill_cntr(list, 100);
+    }
+    const auto cached_counter = app::alloc_counter;
+    ASSERT_LT(counter, cached_counter);
+
+    for(auto i = 0; i < 3; i++)
+    {
+        list_t list;
+        app::fill_cntr(list, 100);
+        ASSERT_EQ(cached_counter, app::alloc_counter);
+
+        std::ostringstream log;
+        auto it = list.begin();
+        for(auto j = 0; j < 3; j++, ++it)
+            log << *it << ',';
+        ASSERT_EQ(log.str(), "0,1,2,");
+    }
+    ASSERT_EQ(cached_counter, app::alloc_counter);
+
+    recycled_chunk_cache<4, 8>::trim();
+    ASSERT_EQ(counter, app::alloc_counter);
+}
+
+namespace {
+
+using exit_cache = allocator::recycled_chunk_cache<2, 4>;
+using exit_list = allocator::linked_list<int, allocator::chunk_allocator<int, 2, allocator::memory_strategy::NONE, exit_cache>>;
+
+//Created before the caches and destroyed after them at program exit
+exit_list static_list;
+
+}
+
+TEST(chunk_cache_case, teardown_order_test)
+{
+    app::fill_cntr(static_list, 100);
+    ASSERT_EQ(static_list.front(), 0);
+
+    const auto counter = app::alloc_counter;
+    std::thread worker([]() {
+        //Destroyed at thread exit after the thread local cache
+        thread_local exit_list list;
+        app::fill_cntr(list, 100);
+        list.clear();
+        app::fill_cntr(list, 100);
+    });
+    worker.join();
+    exit_cache::trim();
+    ASSERT_EQ(counter, app::alloc_counter);
+}
+
+TEST(chunk_cache_case, map_lifo_test)
+{
+    using namespace allocator;
+    using cached_alloc = chunk_allocator<std::pair<const int, int>, 2, memory_strategy::LIFO, recycled_chunk_cache<>>;
+    using map_custom_alloc = app::int_map<int, cached_alloc>;
+    auto make_pair = [i = 0]() mutable { auto value = std::make_pair(i, i); ++i; return value; };
+
+    {
+        map_custom_alloc map;
+        app::generate_sorted(map, 100, make_pair);
+    }
+    const auto cached_counter = app::alloc_counter;
+    {
+        map_custom_alloc map;
+        app::generate_sorted(map, 100, make_pair);
+        for(auto i = 0; i < 100; i += 2)
+            map.erase(i);
+        app::generate_sorted(map, 100, make_pair);
+        ASSERT_EQ(map.size(), 100u);
+    }
+    ASSERT_EQ(cached_counter, app::alloc_counter);
+    recycled_chunk_cache<>::trim();
+}
+
+
+TEST(bulk_release_case, release_all_test)
+{
+    using namespace allocator;
+    using alloc_t = chunk_allocator<short, 2, memory_strategy::LIFO, recycled_chunk_cache<2, 4>>;
+    alloc_t::trim_cache();
+    const auto before = statistics();
+    {
+        alloc_t allocator;
+        for(size_t i = 0; i < 20 * alloc_t::chunk_capacity(); i++)
+            allocator.allocate(1);
+        allocator.release_all();
+
+        //The caches keep a few chunks, the others are freed with their cells
+        auto stats = statistics();
+        ASSERT_EQ(before.live_cells, stats.live_cells);
+        ASSERT_LT(before.chunks, stats.chunks);
+        ASSERT_GE(before.chunks + 6, stats.chunks);
+
+        //A kept chunk is reset and serves new allocations
+        auto * ptr = allocator.allocate(1);
+        ASSERT_EQ(stats.chunks, statistics().chunks);
+        allocator.deallocate(ptr, 1);
+    }
+    alloc_t::trim_cache();
+    ASSERT_EQ(before.chunks, statistics().chunks);
+}
+
+TEST(bulk_release_case, list_clear_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using namespace allocator;
+        linked_list<std::string, chunk_allocator<std::string>> list;
+        for(auto i = 0; i < 100; i++)
+            list.push_front(std::string(100, 'a' + i % 26));
+        list.clear();
+        ASSERT_TRUE(list.empty());
+        ASSERT_EQ(counter, app::alloc_counter);
+
+        list.push_front("value");
+        ASSERT_EQ(list.front(), "value");
+
+        linked_list<int, chunk_allocator<int>> numbers;
+        app::fill_cntr(numbers, 1000);
+        numbers.clear();
+        app::fill_cntr(numbers, 3);
+        std::ostringstream log;
+        for (const auto &value : numbers)
+            log << value << ',';
+        ASSERT_EQ(log.str(), "0,1,2,");
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+
+TEST(locality_case, descending_order_test)
+{
+    const auto counter = app::alloc_counter;
+    {
+        using namespace allocator;
+        using alloc_t = chunk_allocator<int, 4, memory_strategy::NONE, no_chunk_cache, allocation_order::DESCENDING>;
+        linked_list<int, alloc_t> list;
+        for(auto i = 31; i >= 0; i--)
+            list.push_front(i);
+
+        //All nodes are in one chunk and iteration goes forward in memory
+        auto expected = 0;
+        const int * previous = nullptr;
+        for (auto & value : list)
+        {
+            ASSERT_EQ(expected++, value);
+            ASSERT_TRUE(nullptr == previous || previous < &value);
+            previous = &value;
+        }
+        ASSERT_EQ(32, expected);
+    }
+    const auto after_counter = app::alloc_counter;
+    ASSERT_EQ(counter, after_counter);
+}
+
+TEST(locality_case, descending_reuse_test)
+{
+    using namespace allocator;
+    chunk_allocator<int, 2, memory_strategy::LIFO, no_chunk_cache, allocation_order::DESCENDING> allocator;
+    auto * first = allocator.allocate(1);
+    auto * second = allocator.allocate(1);
+    ASSERT_LT(second, first);
+    allocator.deallocate(first, 1);
+    ASSERT_EQ(first, allocator.allocate(1));
+    allocator.deallocate(second, 1);
+    allocator.deallocate(first, 1);
+}
+
+
+TEST(chunk_sizing_case, byte_budget_test)
+{
+    using namespace allocator;
+    using page_alloc = chunk_allocator<int, chunk_bytes(4096)>;
+    static_assert(page_alloc::chunk_footprint() <= 4096, "The chunk has to fit a page");
+    static_assert(page_alloc::chunk_alignment() == 4096, "The chunk has to be page aligned");
+    ASSERT_GT(page_alloc::chunk_capacity(), 200u);
+
+    const auto counter = app::alloc_counter;
+    {
+        page_alloc allocator;
+        std::vector<int*> pointers(page_alloc::chunk_capacity() + 1);
+        for(auto & ptr : pointers)
+            ptr = allocator.allocate(1);
+
+        //The cells of the first chunk are on the same page, the next one
+        //starts another chunk
+        const auto page = reinterpret_cast<std::uintptr_t>(pointers.front()) / 4096;
+        for(auto it = pointers.begin(); it != pointers.end() - 1; ++it)
+            ASSERT_EQ(page, reinterpret_cast<std::uintptr_t>(*it) / 4096);
+        ASSERT_NE(page, reinterpret_cast<std::uintptr_t>(pointers.back()) / 4096);
+
+        for(auto * ptr : pointers)
+            allocator.deallocate(ptr, 1);
+    }
+    ASSERT_EQ(counter, app::alloc_counter);
+
+    using huge_page_alloc = chunk_allocator<std::pair<const int, int>, chunk_bytes(2 * 1024 * 1024)>;
+    app::int_map<int, huge_page_alloc> map;
+    app::generate_sorted(map, 100000, [i = 0]() mutable { auto value = std::make_pair(i, i); ++i; return value; });
+    ASSERT_EQ(map.size(), 100000u);
+}
+
+struct alignas(128) over_aligned
+{
+    int value;
+};
+
+TEST(chunk_sizing_case, over_aligned_test)
+{
+    using namespace allocator;
+    using alloc_t = chunk_allocator<over_aligned, 2>;
+    static_assert(alloc_t::chunk_alignment() >= 128, "Over-aligned types need aligned chunks");
+
+    alloc_t allocator;
+    std::vector<over_aligned*> pointers(40);
+    for(auto & ptr : pointers)
+    {
+        ptr = allocator.allocate(1);
+        ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(ptr) % 128);
+    }
+    for(auto * ptr : pointers)
+        allocator.deallocate(ptr, 1);
+}
+
+TEST(statistics_case, chunk_counters_test)
+{
+    using namespace allocator;
+    using alloc_t = chunk_allocator<int, 10, memory_strategy::LIFO>;
+    const size_t capacity = alloc_t::chunk_capacity();
+    const auto before = statistics();
+    {
+        alloc_t allocator;
+        std::vector<int*> pointers(capacity + 5);
+        for(auto & ptr : pointers)
+            ptr = allocator.allocate(1);
+
+        auto stats = statistics();
+        ASSERT_EQ(before.chunks + 2, stats.chunks);
+        ASSERT_EQ(before.reserved_bytes + 2 * alloc_t::chunk_footprint(), stats.reserved_bytes);
+        ASSERT_EQ(before.live_cells + pointers.size(), stats.live_cells);
+        ASSERT_EQ(before.live_bytes + pointers.size() * sizeof(int), stats.live_bytes);
+
+        //The second chunk is empty after that and is released
+        for(auto it = pointers.begin() + capacity; it != pointers.end(); ++it)
+            allocator.deallocate(*it, 1);
+        stats = statistics();
+        ASSERT_EQ(before.chunks + 1, stats.chunks);
+        ASSERT_EQ(before.live_cells + capacity, stats.live_cells);
+
+        allocator.release_all();
+        stats = statistics();
+        ASSERT_EQ(before.chunks, stats.chunks);
+        ASSERT_EQ(before.live_cells, stats.live_cells);
+    }
+    const auto after = statistics();
+    ASSERT_EQ(before.chunks, after.chunks);
+    ASSERT_EQ(before.reserved_bytes, after.reserved_bytes);
+    ASSERT_EQ(before.live_bytes, after.live_bytes);
+}
+
+TEST(checked_case, foreign_pointer_test)
+{
+    using namespace allocator;
+    auto counter = app::alloc_counter;
+    {
+        chunk_allocator<int, 10, memory_strategy::NONE, no_chunk_cache,
+                        allocation_order::ASCENDING, deallocation_check::CHECKED> first, second;
+        auto * ptr = first.allocate(1);
+        auto * other = second.allocate(1);
+
+        ASSERT_THROW(second.deallocate(ptr, 1), std::invalid_argument);
+        ASSERT_THROW(first.deallocate(ptr + 1, 1), std::invalid_argument);
+        ASSERT_THROW(first.deallocate(ptr + 2, 1), std::invalid_argument);
+        ASSERT_THROW(first.deallocate(nullptr, 1), std::invalid_argument);
+
+        //The rejected calls do not change the owner of the pointer
+        first.deallocate(ptr, 1);
+        second.deallocate(other, 1);
+    }
+    ASSERT_EQ(counter, app::alloc_counter);
+}
+
+TEST(checked_case, double_free_test)
+{
+    using namespace allocator;
+    chunk_allocator<int, 2, memory_strategy::NONE, no_chunk_cache,
+                    allocation_order::ASCENDING, deallocation_check::CHECKED> allocator;
+    auto * first = allocator.allocate(1);
+    auto * second = allocator.allocate(1);
+
+    allocator.deallocate(first, 1);
+    ASSERT_THROW(allocator.deallocate(first, 1), std::invalid_argument);
+
+    //The usage counter is intact, the chunk still serves the freed cell
+    ASSERT_EQ(first, allocator.allocate(1));
+    allocator.deallocate(first, 1);
+    allocator.deallocate(second, 1);
+}
+
+TEST(checked_case, released_chunk_test)
+{
+    using namespace allocator;
+    chunk_allocator<int, 2, memory_strategy::LIFO, no_chunk_cache,
+                    allocation_order::ASCENDING, deallocation_check::CHECKED> allocator;
+    auto * ptr = allocator.allocate(1);
+
+    //The chunk of the last cell is released, its memory is not read again
+    allocator.deallocate(ptr, 1);
+    ASSERT_THROW(allocator.deallocate(ptr, 1), std::invalid_argument);
+}
+
+TEST(checked_case, heap_pointer_test)
+{
+    using namespace allocator;
+    chunk_allocator<int, 2, memory_strategy::NONE, no_chunk_cache,
+                    allocation_order::ASCENDING, deallocation_check::CHECKED> allocator;
+    auto * own = allocator.allocate(1);
+    auto * heap = new int(0);
+
+    ASSERT_THROW(allocator.deallocate(heap, 1), std::invalid_argument);
+    ASSERT_EQ(0, *heap);
+    delete heap;
+    allocator.deallocate(own, 1);
+}
+
+TEST(checked_case, checked_map_test)
+{
+    using namespace allocator;
+    using checked_alloc = chunk_allocator<std::pair<const int, int>, 2, memory_strategy::LIFO, no_chunk_cache,
+                                          allocation_order::ASCENDING, deallocation_check::CHECKED>;
+    auto counter = app::alloc_counter;
+    {
+        app::int_map<int, checked_alloc> map;
+        app::generate_sorted(map, 100, [i = 0]() mutable { auto value = std::make_pair(i, i); ++i; return value; });
+        for(auto i = 0; i < 100; i += 2)
+            map.erase(i);
+        ASSERT_EQ(map.size(), 50u);
+    }
+    ASSERT_EQ(counter, app::alloc_counter);
+}
+
+TEST(checked_case, trusted_double_free_test)
+{
+    using namespace allocator;
+    chunk_allocator<int, 2, memory_strategy::NONE> allocator;
+    auto * first = allocator.allocate(1);
+    auto * second = allocator.allocate(1);
+
+    //A double free is ignored and does not corrupt the usage counter
+    allocator.deallocate(first, 1);
+    allocator.deallocate(first, 1);
+    ASSERT_EQ(first, allocator.allocate(1));
+    allocator.deallocate(first, 1);
+    allocator.deallocate(second, 1);
+}
+
+TEST(checked_case, merged_chunks_test)
+{
+    using namespace allocator;
+    chunk_allocator<int, 2, memory_strategy::LIFO, no_chunk_cache,
+                    allocation_order::ASCENDING, deallocation_check::CHECKED> first, second;
+    auto * ptr = second.allocate(1);
+    auto * other = second.allocate(1);
+
+    //The chunks and their table entries move to the first allocator
+    first.merge(second);
+    ASSERT_THROW(second.deallocate(ptr, 1), std::invalid_argument);
+    first.deallocate(ptr, 1);
+    ASSERT_THROW(first.deallocate(ptr, 1), std::invalid_argument);
+    first.deallocate(other, 1);
+}
+
+
 int main(int argc, char **argv) {
   InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();